@@ -0,0 +1,169 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+
+#include <dart/collision/CollisionFilter.hpp>
+#include <dart/collision/CollisionGroup.hpp>
+#include <dart/collision/CollisionObject.hpp>
+#include <dart/collision/dart/DARTCollisionDetector.hpp>
+#include <dart/constraint/ConstraintSolver.hpp>
+
+#include <robot_dart/control/pd_control.hpp>
+#include <robot_dart/robot_dart_simu.hpp>
+
+using CollisionPair = std::pair<const dart::collision::CollisionObject*, const dart::collision::CollisionObject*>;
+
+// previous implementation of the mask lookup (one std::unordered_map per shape), kept for comparison
+class HashMapFilter : public dart::collision::BodyNodeCollisionFilter {
+public:
+    bool ignoresCollision(const dart::collision::CollisionObject* object1, const dart::collision::CollisionObject* object2) const override
+    {
+        if (dart::collision::BodyNodeCollisionFilter::ignoresCollision(object1, object2))
+            return true;
+
+        auto shape1_iter = masks.find(object1->getShapeFrame()->asShapeNode());
+        auto shape2_iter = masks.find(object2->getShapeFrame()->asShapeNode());
+        return shape1_iter != masks.end() && shape2_iter != masks.end() && ((shape1_iter->second & shape2_iter->second) == 0);
+    }
+
+    std::unordered_map<const dart::dynamics::ShapeNode*, uint16_t> masks;
+};
+
+// records the candidate pairs given to the filter by the collision detector (and filters nothing out)
+class RecordingFilter : public dart::collision::CollisionFilter {
+public:
+    bool ignoresCollision(const dart::collision::CollisionObject* object1, const dart::collision::CollisionObject* object2) const override
+    {
+        pairs.push_back(std::make_pair(object1, object2));
+        return false;
+    }
+
+    mutable std::vector<CollisionPair> pairs;
+};
+
+std::shared_ptr<robot_dart::Robot> hexapod(const std::shared_ptr<robot_dart::Robot>& global_robot, size_t i)
+{
+    auto robot = global_robot->clone();
+    // on a grid, close enough for the broadphase to report the neighbors
+    robot->skeleton()->setPosition(3, 0.5 * (i % 4));
+    robot->skeleton()->setPosition(4, 0.5 * (i / 4));
+    robot->skeleton()->setPosition(5, 0.15);
+    return robot;
+}
+
+// contact-heavy scene: many hexapods walking (open-loop sinusoids) on the same floor
+// the robots are given collision masks so that they only collide with the floor (every robot/robot pair is filtered out)
+double run(bool masks, size_t num_robots, double duration)
+{
+    auto global_robot = std::make_shared<robot_dart::Robot>("res/models/pexod.urdf");
+    global_robot->set_position_enforced(true);
+
+    robot_dart::RobotDARTSimu simu(0.001);
+    simu.set_control_freq(50);
+    simu.add_floor(20.);
+
+    std::vector<std::shared_ptr<robot_dart::control::PDControl>> controllers;
+    for (size_t i = 0; i < num_robots; i++) {
+        auto robot = hexapod(global_robot, i);
+        auto ctrl = std::make_shared<robot_dart::control::PDControl>(Eigen::VectorXd::Zero(robot->dof_names(true, true, true).size()));
+        robot->add_controller(ctrl);
+        ctrl->set_pd(20., 0.);
+        controllers.push_back(ctrl);
+
+        simu.add_robot(robot);
+        if (masks)
+            simu.set_collision_mask(i, static_cast<uint16_t>(1 << (i % 16)));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t steps = 0;
+    while (simu.scheduler().next_time() < duration) {
+        // change the targets at the control frequency (50Hz, tripod-like gait); step() applies them
+        if (simu.schedule(simu.control_freq())) {
+            double t = simu.scheduler().current_time();
+            for (auto& ctrl : controllers) {
+                Eigen::VectorXd target = ctrl->parameters();
+                for (int j = 0; j < target.size(); j++)
+                    target[j] = 0.3 * std::sin(2. * M_PI * t + (j % 2) * M_PI);
+                ctrl->set_parameters(target);
+            }
+        }
+        simu.step();
+        steps++;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << (masks ? "with masks:    " : "without masks: ") << steps / elapsed.count() << " steps/s, "
+              << simu.world()->getLastCollisionResult().getNumContacts() << " contacts in the last step" << std::endl;
+    return elapsed.count();
+}
+
+// cost of the filter alone: every candidate pair of the robots (all their shapes have a mask) is checked repeatedly
+// with the BodyNodeCollisionFilter only (no masks), the previous std::unordered_map lookup and the current filter
+void filter_lookup(size_t num_robots, size_t repeats)
+{
+    auto global_robot = std::make_shared<robot_dart::Robot>("res/models/pexod.urdf");
+
+    robot_dart::RobotDARTSimu simu(0.001);
+    auto hash_map_filter = std::make_shared<HashMapFilter>();
+    for (size_t i = 0; i < num_robots; i++) {
+        auto robot = hexapod(global_robot, i);
+        simu.add_robot(robot);
+        // all the masks interact: only the cost of the lookup is measured (nothing is filtered out by the masks)
+        simu.set_collision_mask(i, 0xffff);
+        for (size_t s = 0; s < robot->skeleton()->getNumShapeNodes(); s++)
+            hash_map_filter->masks[robot->skeleton()->getShapeNode(s)] = 0xffff;
+    }
+
+    auto detector = dart::collision::DARTCollisionDetector::create();
+    auto group = detector->createCollisionGroup();
+    for (auto& robot : simu.robots())
+        group->addShapeFramesOf(robot->skeleton().get());
+
+    auto recorder = std::make_shared<RecordingFilter>();
+    // the detector stops at maxNumContacts collisions
+    dart::collision::CollisionOption option(false, 1000000, recorder);
+    dart::collision::CollisionResult result;
+    group->collide(option, &result);
+    const auto& pairs = recorder->pairs;
+
+    auto time = [&pairs, repeats](const dart::collision::CollisionFilter& filter) {
+        size_t ignored = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < repeats; r++)
+            for (auto& pair : pairs)
+                ignored += filter.ignoresCollision(pair.first, pair.second);
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return std::make_pair(elapsed.count() / (repeats * pairs.size()), ignored);
+    };
+
+    dart::collision::BodyNodeCollisionFilter body_node_filter;
+    auto current_filter = simu.world()->getConstraintSolver()->getCollisionOption().collisionFilter;
+    auto none = time(body_node_filter);
+    auto hash_map = time(*hash_map_filter);
+    auto current = time(*current_filter);
+
+    std::cout << pairs.size() << " candidate pairs, " << group->getNumShapeFrames() << " shapes with a mask" << std::endl;
+    std::cout << "  BodyNodeCollisionFilter only: " << none.first << " ns/pair" << std::endl;
+    std::cout << "  unordered_map masks:          " << hash_map.first << " ns/pair" << std::endl;
+    std::cout << "  dense array masks (current):  " << current.first << " ns/pair" << std::endl;
+    if (none.second != hash_map.second || none.second != current.second)
+        std::cout << "  warning: the filters do not agree" << std::endl;
+}
+
+int main()
+{
+    size_t num_robots = 16;
+    double duration = 2.;
+
+    std::cout << "filter lookup, " << num_robots << " hexapods" << std::endl;
+    filter_lookup(num_robots, 200);
+
+    std::cout << num_robots << " hexapods, " << duration << "s of simulation" << std::endl;
+    double without_masks = run(false, num_robots, duration);
+    double with_masks = run(true, num_robots, duration);
+    std::cout << "speed-up of masking: " << without_masks / with_masks << std::endl;
+
+    return 0;
+}
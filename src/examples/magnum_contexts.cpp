@@ -2,6 +2,7 @@
 #include <thread>
 
 #include <robot_dart/robot_dart_simu.hpp>
+#include <robot_dart/robot_prototype.hpp>
 
 #include <robot_dart/control/pd_control.hpp>
 
@@ -17,6 +18,8 @@ int main()
 
     global_robot->fix_to_world();
     global_robot->set_position_enforced(true);
+    // the workers clone the prototype concurrently without locking
+    robot_dart::RobotPrototype prototype(global_robot);
 
     std::vector<std::thread> workers;
 
@@ -40,7 +43,7 @@ int main()
             get_gl_context_with_sleep(gl_context, 20); // this call will sleep 20ms between each failed query
 
             // Do the simulation
-            auto g_robot = global_robot->clone();
+            auto g_robot = prototype.clone();
 
             robot_dart::RobotDARTSimu simu(0.001);
 
@@ -0,0 +1,42 @@
+#include <iostream>
+
+#include <robot_dart/control/pd_control.hpp>
+#include <robot_dart/robot_dart_simu.hpp>
+
+#include <robot_dart/gui/magnum/pipelined_windowless_graphics.hpp>
+
+int main()
+{
+    std::vector<std::pair<std::string, std::string>> packages = {{"iiwa14", std::string(RESPATH) + "/models/meshes"}};
+    auto robot = std::make_shared<robot_dart::Robot>("res/models/iiwa14.urdf", packages);
+    robot->fix_to_world();
+    robot->set_position_enforced(true);
+
+    Eigen::VectorXd ctrl(7);
+    ctrl << 0., M_PI / 3., 0., -M_PI / 4., 0., 0., 0.;
+    robot->add_controller(std::make_shared<robot_dart::control::PDControl>(ctrl));
+    std::static_pointer_cast<robot_dart::control::PDControl>(robot->controllers()[0])->set_pd(300., 50.);
+
+    robot_dart::RobotDARTSimu simu(0.001);
+
+    // the frames are rendered on a separate thread while the physics continues
+    robot_dart::gui::magnum::GraphicsConfiguration configuration;
+    configuration.width = 1024;
+    configuration.height = 768;
+    configuration.draw_debug = false;
+    auto graphics = std::make_shared<robot_dart::gui::magnum::PipelinedWindowlessGraphics>(&simu, configuration);
+    simu.set_graphics(graphics);
+    graphics->look_at({0., 3.5, 2.}, {0., 0., 0.25});
+
+    simu.add_floor();
+    simu.add_robot(robot);
+    simu.run(5.);
+
+    // latest completed frame
+    simu.graphics()->finish();
+    robot_dart::gui::save_png_image("pipelined.png", graphics->image());
+    std::cout << "rendered frames: " << graphics->frame_counter() << std::endl;
+
+    robot.reset();
+    return 0;
+}
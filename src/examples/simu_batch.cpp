@@ -0,0 +1,42 @@
+#include <iostream>
+
+#include <robot_dart/control/pd_control.hpp>
+#include <robot_dart/simu_batch.hpp>
+
+int main()
+{
+    auto global_robot = std::make_shared<robot_dart::Robot>("res/models/arm.urdf");
+    global_robot->fix_to_world();
+    global_robot->set_position_enforced(true);
+
+    // 64 headless worlds stepped by all the available hardware threads
+    size_t N_worlds = 64;
+    robot_dart::SimuBatch batch(N_worlds, 0.001);
+
+    for (size_t i = 0; i < batch.size(); i++) {
+        auto robot = global_robot->clone();
+
+        Eigen::VectorXd ctrl = Eigen::VectorXd::Random(robot->dof_names(true, true, true).size());
+        robot->add_controller(std::make_shared<robot_dart::control::PDControl>(ctrl));
+        std::static_pointer_cast<robot_dart::control::PDControl>(robot->controller(0))->set_pd(200., 20.);
+
+        batch.simu(i)->add_floor();
+        batch.simu(i)->add_robot(robot);
+    }
+
+    // step all the worlds together for 1 second
+    for (size_t k = 0; k < 1000; k++) {
+        if (batch.step())
+            break;
+    }
+
+    // then let them run for 2 more seconds
+    batch.run(2.);
+
+    std::cout << "done worlds: " << batch.num_done() << "/" << batch.size() << std::endl;
+    for (size_t i = 0; i < 4; i++)
+        std::cout << i << ": " << batch.simu(i)->robot(0)->positions().transpose() << std::endl;
+
+    global_robot.reset();
+    return 0;
+}
@@ -88,6 +88,7 @@ namespace robot_dart {
                 .def("active", &RobotControl::active)
 
                 .def("controllable_dofs", &RobotControl::controllable_dofs)
+                .def("controllable_dof_view", &RobotControl::controllable_dof_view)
 
                 .def("weight", &RobotControl::weight)
                 .def("set_weight", &RobotControl::set_weight)
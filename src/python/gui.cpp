@@ -9,6 +9,7 @@
 #ifdef GRAPHIC
 #include <robot_dart/gui/magnum/camera_osr.hpp>
 #include <robot_dart/gui/magnum/graphics.hpp>
+#include <robot_dart/gui/magnum/pipelined_windowless_graphics.hpp>
 #include <robot_dart/gui/magnum/windowless_graphics.hpp>
 #endif
 
@@ -188,6 +189,38 @@ namespace robot_dart {
 
                 .def("magnum_app", (gui::magnum::BaseApplication * (WindowlessGraphics::*)()) & WindowlessGraphics::magnum_app, py::return_value_policy::reference);
 
+            // PipelinedWindowlessGraphics class
+            py::class_<PipelinedWindowlessGraphics, gui::Base, std::shared_ptr<PipelinedWindowlessGraphics>>(sm, "PipelinedWindowlessGraphics")
+                .def(py::init<RobotDARTSimu*, const GraphicsConfiguration&>())
+
+                .def("done", &PipelinedWindowlessGraphics::done)
+                .def("refresh", &PipelinedWindowlessGraphics::refresh,
+                    py::call_guard<py::gil_scoped_release>())
+                .def("finish", &PipelinedWindowlessGraphics::finish,
+                    py::call_guard<py::gil_scoped_release>())
+                .def("set_enable", &PipelinedWindowlessGraphics::set_enable)
+                .def("frame_counter", &PipelinedWindowlessGraphics::frame_counter)
+
+                .def("look_at", &PipelinedWindowlessGraphics::look_at,
+                    py::arg("camera_pos"),
+                    py::arg("look_at") = Eigen::Vector3d(0, 0, 0),
+                    py::arg("up") = Eigen::Vector3d(0, 0, 1))
+
+                .def("clear_lights", &PipelinedWindowlessGraphics::clear_lights)
+                .def("add_light", &PipelinedWindowlessGraphics::add_light)
+                .def("enable_shadows", &PipelinedWindowlessGraphics::enable_shadows,
+                    py::arg("enable") = true,
+                    py::arg("transparent") = true)
+                .def("record_depth", &PipelinedWindowlessGraphics::record_depth,
+                    py::arg("recording_depth") = true)
+                .def("record_video", &PipelinedWindowlessGraphics::record_video,
+                    py::arg("video_fname"),
+                    py::arg("fps") = -1)
+
+                .def("image", &PipelinedWindowlessGraphics::image)
+                .def("depth_image", &PipelinedWindowlessGraphics::depth_image)
+                .def("raw_depth_image", &PipelinedWindowlessGraphics::raw_depth_image);
+
             sm.def(
                 "run_with_gl_context", +[](const std::function<void()>& func, size_t wait_ms) {
                     get_gl_context_with_sleep(my_context, wait_ms);
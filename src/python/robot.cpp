@@ -3,7 +3,11 @@
 #include <pybind11/eigen.h>
 #include <pybind11/stl.h>
 
+#include <robot_dart/collision_shape_cache.hpp>
+#include <robot_dart/damage_variants.hpp>
+#include <robot_dart/model_cache.hpp>
 #include <robot_dart/robot.hpp>
+#include <robot_dart/robot_prototype.hpp>
 
 #include <robot_dart/control/robot_control.hpp>
 
@@ -12,6 +16,42 @@ namespace robot_dart {
         void py_robot(py::module& m)
         {
             using namespace robot_dart;
+            // ModelCache class (singleton)
+            py::class_<ModelCache, std::unique_ptr<ModelCache, py::nodelete>>(m, "ModelCache")
+                .def_static("instance", &ModelCache::instance, py::return_value_policy::reference)
+
+                .def("set_enabled", &ModelCache::set_enabled)
+                .def("enabled", &ModelCache::enabled)
+
+                .def("preload", &ModelCache::preload,
+                    py::arg("model_file"),
+                    py::arg("packages") = ModelCache::packages_t())
+                .def("evict", &ModelCache::evict)
+                .def("clear", &ModelCache::clear)
+                .def("size", &ModelCache::size);
+
+            // CollisionShapeCache class (singleton)
+            py::class_<CollisionShapeCache, std::unique_ptr<CollisionShapeCache, py::nodelete>>(m, "CollisionShapeCache")
+                .def_static("instance", &CollisionShapeCache::instance, py::return_value_policy::reference)
+
+                .def("set_directory", &CollisionShapeCache::set_directory)
+                .def("directory", &CollisionShapeCache::directory)
+
+                .def("clear", &CollisionShapeCache::clear)
+                .def("size", &CollisionShapeCache::size);
+
+            // DofView class
+            py::class_<DofView>(m, "DofView")
+                .def(py::init<>())
+                .def("dof_names", &DofView::dof_names)
+                .def("all_dofs", &DofView::all_dofs);
+
+            // BodyView class
+            py::class_<BodyView>(m, "BodyView")
+                .def(py::init<>())
+                .def("body_names", &BodyView::body_names)
+                .def("all_bodies", &BodyView::all_bodies);
+
             // Robot class
             py::class_<Robot, std::shared_ptr<Robot>>(m, "Robot")
                 .def(py::init<const std::string&, const std::vector<std::pair<std::string, std::string>>&, const std::string&, bool>())
@@ -24,6 +64,10 @@ namespace robot_dart {
                     py::arg("ghost_color") = Eigen::Vector4d{0.3, 0.3, 0.3, 0.7})
                 .def("skeleton", &Robot::skeleton)
 
+                .def("simplify_collision_shapes", &Robot::simplify_collision_shapes,
+                    py::arg("type") = "convex_hull",
+                    py::arg("body_names") = std::vector<std::string>())
+
                 .def("name", &Robot::name)
 
                 .def("update", &Robot::update)
@@ -103,35 +147,82 @@ namespace robot_dart {
                 .def("com_velocity", &Robot::com_velocity)
                 .def("com_acceleration", &Robot::com_acceleration)
 
-                .def("positions", &Robot::positions,
+                .def("positions", (Eigen::VectorXd(Robot::*)(const std::vector<std::string>&)) & Robot::positions,
                     py::arg("dof_names") = std::vector<std::string>())
-                .def("set_positions", &Robot::set_positions,
+                .def("positions", (Eigen::VectorXd(Robot::*)(const DofView&)) & Robot::positions,
+                    py::arg("view"))
+                .def("set_positions", (void (Robot::*)(const Eigen::VectorXd&, const std::vector<std::string>&)) & Robot::set_positions,
                     py::arg("positions"),
                     py::arg("dof_names") = std::vector<std::string>())
+                .def("set_positions", (void (Robot::*)(const Eigen::VectorXd&, const DofView&)) & Robot::set_positions,
+                    py::arg("positions"),
+                    py::arg("view"))
 
-                .def("velocities", &Robot::velocities,
+                .def("velocities", (Eigen::VectorXd(Robot::*)(const std::vector<std::string>&)) & Robot::velocities,
                     py::arg("dof_names") = std::vector<std::string>())
-                .def("set_velocities", &Robot::set_velocities,
+                .def("velocities", (Eigen::VectorXd(Robot::*)(const DofView&)) & Robot::velocities,
+                    py::arg("view"))
+                .def("set_velocities", (void (Robot::*)(const Eigen::VectorXd&, const std::vector<std::string>&)) & Robot::set_velocities,
                     py::arg("velocities"),
                     py::arg("dof_names") = std::vector<std::string>())
+                .def("set_velocities", (void (Robot::*)(const Eigen::VectorXd&, const DofView&)) & Robot::set_velocities,
+                    py::arg("velocities"),
+                    py::arg("view"))
 
-                .def("accelerations", &Robot::accelerations,
+                .def("accelerations", (Eigen::VectorXd(Robot::*)(const std::vector<std::string>&)) & Robot::accelerations,
                     py::arg("dof_names") = std::vector<std::string>())
-                .def("set_accelerations", &Robot::set_accelerations,
+                .def("accelerations", (Eigen::VectorXd(Robot::*)(const DofView&)) & Robot::accelerations,
+                    py::arg("view"))
+                .def("set_accelerations", (void (Robot::*)(const Eigen::VectorXd&, const std::vector<std::string>&)) & Robot::set_accelerations,
                     py::arg("accelerations"),
                     py::arg("dof_names") = std::vector<std::string>())
+                .def("set_accelerations", (void (Robot::*)(const Eigen::VectorXd&, const DofView&)) & Robot::set_accelerations,
+                    py::arg("accelerations"),
+                    py::arg("view"))
 
-                .def("forces", &Robot::forces,
+                .def("forces", (Eigen::VectorXd(Robot::*)(const std::vector<std::string>&)) & Robot::forces,
                     py::arg("dof_names") = std::vector<std::string>())
-                .def("set_forces", &Robot::set_forces,
+                .def("forces", (Eigen::VectorXd(Robot::*)(const DofView&)) & Robot::forces,
+                    py::arg("view"))
+                .def("set_forces", (void (Robot::*)(const Eigen::VectorXd&, const std::vector<std::string>&)) & Robot::set_forces,
                     py::arg("forces"),
                     py::arg("dof_names") = std::vector<std::string>())
+                .def("set_forces", (void (Robot::*)(const Eigen::VectorXd&, const DofView&)) & Robot::set_forces,
+                    py::arg("forces"),
+                    py::arg("view"))
 
-                .def("commands", &Robot::commands,
+                .def("commands", (Eigen::VectorXd(Robot::*)(const std::vector<std::string>&)) & Robot::commands,
                     py::arg("dof_names") = std::vector<std::string>())
-                .def("set_commands", &Robot::set_commands,
+                .def("commands", (Eigen::VectorXd(Robot::*)(const DofView&)) & Robot::commands,
+                    py::arg("view"))
+                .def("set_commands", (void (Robot::*)(const Eigen::VectorXd&, const std::vector<std::string>&)) & Robot::set_commands,
                     py::arg("commands"),
                     py::arg("dof_names") = std::vector<std::string>())
+                .def("set_commands", (void (Robot::*)(const Eigen::VectorXd&, const DofView&)) & Robot::set_commands,
+                    py::arg("commands"),
+                    py::arg("view"))
+
+                .def("dof_view", &Robot::dof_view)
+
+                // out must be a contiguous float64 numpy array (written in place)
+                .def("positions_into", &Robot::positions_into,
+                    py::arg("out"),
+                    py::arg("view") = DofView())
+                .def("velocities_into", &Robot::velocities_into,
+                    py::arg("out"),
+                    py::arg("view") = DofView())
+                .def("accelerations_into", &Robot::accelerations_into,
+                    py::arg("out"),
+                    py::arg("view") = DofView())
+                .def("forces_into", &Robot::forces_into,
+                    py::arg("out"),
+                    py::arg("view") = DofView())
+                .def("commands_into", &Robot::commands_into,
+                    py::arg("out"),
+                    py::arg("view") = DofView())
+                .def("state_into", &Robot::state_into,
+                    py::arg("out"),
+                    py::arg("view") = DofView())
 
                 .def("force_torque", &Robot::force_torque)
 
@@ -177,6 +268,24 @@ namespace robot_dart {
                     py::arg("torque"),
                     py::arg("local") = false)
 
+                // wrenches: (n, 6) float64 numpy array (a C-contiguous array is not copied)
+                .def("set_external_wrenches", (void (Robot::*)(const std::vector<size_t>&, const Eigen::Ref<const Robot::wrenches_t>&, bool)) & Robot::set_external_wrenches,
+                    py::arg("body_indices"),
+                    py::arg("wrenches"),
+                    py::arg("local") = false)
+                .def("set_external_wrenches", (void (Robot::*)(const BodyView&, const Eigen::Ref<const Robot::wrenches_t>&, bool)) & Robot::set_external_wrenches,
+                    py::arg("view"),
+                    py::arg("wrenches"),
+                    py::arg("local") = false)
+                .def("add_external_wrenches", (void (Robot::*)(const std::vector<size_t>&, const Eigen::Ref<const Robot::wrenches_t>&, bool)) & Robot::add_external_wrenches,
+                    py::arg("body_indices"),
+                    py::arg("wrenches"),
+                    py::arg("local") = false)
+                .def("add_external_wrenches", (void (Robot::*)(const BodyView&, const Eigen::Ref<const Robot::wrenches_t>&, bool)) & Robot::add_external_wrenches,
+                    py::arg("view"),
+                    py::arg("wrenches"),
+                    py::arg("local") = false)
+
                 .def("clear_external_forces", &Robot::clear_external_forces)
 
                 .def("external_forces", (Eigen::Vector6d(Robot::*)(const std::string& body_name) const) & Robot::external_forces)
@@ -185,6 +294,23 @@ namespace robot_dart {
                 .def("body_pose", (Eigen::Isometry3d(Robot::*)(const std::string& body_name) const) & Robot::body_pose)
                 .def("body_pose", (Eigen::Isometry3d(Robot::*)(size_t body_index) const) & Robot::body_pose)
 
+                .def("body_view", &Robot::body_view)
+                .def("body_indices", &Robot::body_indices)
+                .def(
+                    "body_poses", [](const Robot& robot, const BodyView& view) {
+                        Robot::poses_t poses;
+                        robot.body_poses_into(poses, view);
+                        return std::vector<Eigen::Isometry3d>(poses.begin(), poses.end());
+                    },
+                    py::arg("view") = BodyView())
+                // out must be a Fortran-ordered (column-major) float64 numpy array (written in place)
+                .def("body_twists_into", &Robot::body_twists_into,
+                    py::arg("out"),
+                    py::arg("view") = BodyView())
+                .def("body_linear_jacobians_into", &Robot::body_linear_jacobians_into,
+                    py::arg("out"),
+                    py::arg("view") = BodyView())
+
                 .def("body_names", &Robot::body_names)
                 .def("body_name", &Robot::body_name)
                 .def("set_body_name", &Robot::set_body_name)
@@ -210,6 +336,7 @@ namespace robot_dart {
                 .def("passive_dof_names", &Robot::passive_dof_names)
                 .def("dof_name", &Robot::dof_name)
                 .def("dof_index", &Robot::dof_index)
+                .def("dof_names_version", &Robot::dof_names_version)
 
                 .def("joint_names", &Robot::joint_names)
                 .def("joint_name", &Robot::joint_name)
@@ -250,6 +377,46 @@ namespace robot_dart {
                     py::arg("mass") = 1.,
                     py::arg("color") = dart::Color::Red(1.0),
                     py::arg("ellipsoid_name") = "ellipsoid");
+
+            // RobotPrototype class
+            // the GIL is released while cloning in parallel
+            py::class_<RobotPrototype>(m, "RobotPrototype")
+                .def(py::init<const std::shared_ptr<Robot>&>())
+
+                .def("name", &RobotPrototype::name)
+
+                .def("clone", &RobotPrototype::clone,
+                    py::arg("name") = "")
+                .def("clone_n", (std::vector<std::shared_ptr<Robot>>(RobotPrototype::*)(size_t, size_t) const) & RobotPrototype::clone_n,
+                    py::arg("n"),
+                    py::arg("num_threads") = 0,
+                    py::call_guard<py::gil_scoped_release>());
+
+            // RobotDamage struct (the position of a blocked joint, extra, is not available in python)
+            py::class_<RobotDamage>(m, "RobotDamage")
+                .def(py::init<const std::string&, const std::string&>(),
+                    py::arg("type"),
+                    py::arg("joint_name"))
+                .def(py::init<const std::string&, size_t>(),
+                    py::arg("type"),
+                    py::arg("joint_index"))
+                .def_readwrite("type", &RobotDamage::type)
+                .def_readwrite("data", &RobotDamage::data)
+                .def_readwrite("joint_index", &RobotDamage::joint_index);
+
+            // DamageVariants class
+            py::class_<DamageVariants>(m, "DamageVariants")
+                .def(py::init<const std::shared_ptr<Robot>&>())
+
+                .def("robot", &DamageVariants::robot,
+                    py::arg("damages"),
+                    py::arg("name") = "")
+                .def("preload", &DamageVariants::preload)
+
+                .def("size", &DamageVariants::size)
+                .def("clear", &DamageVariants::clear)
+
+                .def("signature", &DamageVariants::signature);
         }
     } // namespace python
 } // namespace robot_dart
\ No newline at end of file
@@ -1,10 +1,15 @@
 #include "robot_dart.hpp"
 
 #include <pybind11/eigen.h>
+#include <pybind11/functional.h>
 #include <pybind11/operators.h>
 #include <pybind11/stl.h>
 
+#include <robot_dart/descriptor/sensor_buffer.hpp>
+#include <robot_dart/population_evaluator.hpp>
+#include <robot_dart/recorder.hpp>
 #include <robot_dart/robot_dart_simu.hpp>
+#include <robot_dart/simu_batch.hpp>
 
 namespace robot_dart {
     namespace python {
@@ -48,8 +53,150 @@ namespace robot_dart {
 
                 .def("__call__", &Descriptor::operator());
 
+            // SensorBuffer class
+            // the readings are returned as numpy views of the buffers (no copy; valid until the next step)
+            using descriptor::SensorBuffer;
+            py::class_<SensorBuffer, Descriptor, std::shared_ptr<SensorBuffer>>(m, "SensorBuffer")
+                .def(py::init<RobotDARTSimu*, size_t, size_t>(),
+                    py::arg("simu"),
+                    py::arg("desc_dump") = 1,
+                    py::arg("max_contacts") = 256)
+
+                .def("add_force_torque", (size_t(SensorBuffer::*)(const std::shared_ptr<Robot>&, const std::string&)) & SensorBuffer::add_force_torque,
+                    py::arg("robot"),
+                    py::arg("joint_name"))
+                .def("add_force_torque", (size_t(SensorBuffer::*)(const std::shared_ptr<Robot>&, size_t)) & SensorBuffer::add_force_torque,
+                    py::arg("robot"),
+                    py::arg("joint_index"))
+                .def("add_contact_body", &SensorBuffer::add_contact_body,
+                    py::arg("robot"),
+                    py::arg("body_name"))
+                .def("clear", &SensorBuffer::clear)
+
+                .def("num_force_torques", &SensorBuffer::num_force_torques)
+                .def("num_contact_bodies", &SensorBuffer::num_contact_bodies)
+                .def("max_contacts", &SensorBuffer::max_contacts)
+                .def("set_max_contacts", &SensorBuffer::set_max_contacts)
+
+                .def("wrenches", &SensorBuffer::wrenches, py::return_value_policy::reference_internal)
+                .def("num_contacts", &SensorBuffer::num_contacts)
+                .def("dropped_contacts", &SensorBuffer::dropped_contacts)
+                .def("contact_points", &SensorBuffer::contact_points, py::return_value_policy::reference_internal)
+                .def("contact_normals", &SensorBuffer::contact_normals, py::return_value_policy::reference_internal)
+                .def("contact_forces", &SensorBuffer::contact_forces, py::return_value_policy::reference_internal)
+                .def("contact_sensors", &SensorBuffer::contact_sensors)
+                .def("body_contact_forces", &SensorBuffer::body_contact_forces, py::return_value_policy::reference_internal)
+                .def("body_num_contacts", &SensorBuffer::body_num_contacts);
+
+            // SimuState class
+            py::class_<SimuState>(m, "SimuState")
+                .def(py::init<>())
+
+                .def_readwrite("data", &SimuState::data)
+                .def_readwrite("layout", &SimuState::layout);
+
+            // CollisionDetectorProbe class
+            py::class_<CollisionDetectorProbe>(m, "CollisionDetectorProbe")
+                .def(py::init<>())
+
+                .def_readwrite("detector", &CollisionDetectorProbe::detector)
+                .def_readwrite("step_time", &CollisionDetectorProbe::step_time)
+                .def_readwrite("num_contacts", &CollisionDetectorProbe::num_contacts)
+                .def_readwrite("position_error", &CollisionDetectorProbe::position_error)
+                .def_readwrite("consistent", &CollisionDetectorProbe::consistent);
+
+            // TerminationCondition class
+            py::class_<TerminationCondition> termination(m, "TerminationCondition");
+            termination
+                .def_static("com_below", &TerminationCondition::com_below,
+                    py::arg("robot"),
+                    py::arg("height"))
+                .def_static("body_outside_box", &TerminationCondition::body_outside_box,
+                    py::arg("robot"),
+                    py::arg("body_name"),
+                    py::arg("box_min"),
+                    py::arg("box_max"))
+                .def_static("not_finite", &TerminationCondition::not_finite,
+                    py::arg("robot") = nullptr)
+
+                .def("violated", &TerminationCondition::violated)
+
+                .def_readonly("type", &TerminationCondition::type)
+                .def_readonly("robot", &TerminationCondition::robot)
+                .def_readonly("body_index", &TerminationCondition::body_index)
+                .def_readonly("threshold", &TerminationCondition::threshold)
+                .def_readonly("box_min", &TerminationCondition::box_min)
+                .def_readonly("box_max", &TerminationCondition::box_max);
+
+            py::enum_<TerminationCondition::Type>(termination, "Type")
+                .value("COM_BELOW", TerminationCondition::COM_BELOW)
+                .value("BODY_OUTSIDE_BOX", TerminationCondition::BODY_OUTSIDE_BOX)
+                .value("NOT_FINITE", TerminationCondition::NOT_FINITE)
+                .export_values();
+
+            // StepProfiler class
+            py::class_<StepProfiler> profiler(m, "StepProfiler");
+            profiler
+                .def_static("enabled", &StepProfiler::enabled)
+                .def_static("phase_name", &StepProfiler::phase_name)
+
+                .def("stats", &StepProfiler::stats)
+                .def("reset", &StepProfiler::reset)
+                .def("summary", &StepProfiler::summary);
+
+            py::enum_<StepProfiler::Phase>(profiler, "Phase")
+                .value("ROBOT_UPDATE", StepProfiler::ROBOT_UPDATE)
+                .value("WORLD_STEP", StepProfiler::WORLD_STEP)
+                .value("DESCRIPTORS", StepProfiler::DESCRIPTORS)
+                .value("CAMERAS", StepProfiler::CAMERAS)
+                .value("GRAPHICS", StepProfiler::GRAPHICS)
+                .value("GUI_DATA", StepProfiler::GUI_DATA)
+                .value("GRAPHICS_WAIT", StepProfiler::GRAPHICS_WAIT)
+                .export_values();
+
+            py::class_<StepProfiler::Stats>(profiler, "Stats")
+                .def_readonly("count", &StepProfiler::Stats::count)
+                .def_readonly("min", &StepProfiler::Stats::min)
+                .def_readonly("mean", &StepProfiler::Stats::mean)
+                .def_readonly("max", &StepProfiler::Stats::max)
+                .def_readonly("p99", &StepProfiler::Stats::p99)
+                .def_readonly("total", &StepProfiler::Stats::total);
+
+            // Recorder class
+            py::class_<Recorder, std::shared_ptr<Recorder>>(m, "Recorder")
+                .def(py::init<const std::string&, size_t>(),
+                    py::arg("filename"),
+                    py::arg("keyframe_period") = 0)
+
+                .def("filename", &Recorder::filename)
+                .def("keyframe_period", &Recorder::keyframe_period)
+                .def("num_ticks", &Recorder::num_ticks)
+
+                .def("flush", &Recorder::flush)
+                .def("close", &Recorder::close)
+                .def("closed", &Recorder::closed);
+
+            // Replayer class
+            py::class_<Replayer>(m, "Replayer")
+                .def(py::init<const std::string&>(),
+                    py::arg("filename"))
+
+                .def("filename", &Replayer::filename)
+                .def("timestep", &Replayer::timestep)
+                .def("control_freq", &Replayer::control_freq)
+                .def("robot_names", &Replayer::robot_names)
+
+                .def("step", &Replayer::step,
+                    py::arg("simu"),
+                    py::arg("reset_commands") = false)
+                .def("run", &Replayer::run,
+                    py::arg("simu"),
+                    py::arg("reset_commands") = false)
+
+                .def("done", &Replayer::done);
+
             // RobotDARTSimu class
-            py::class_<RobotDARTSimu>(m, "RobotDARTSimu")
+            py::class_<RobotDARTSimu, std::shared_ptr<RobotDARTSimu>>(m, "RobotDARTSimu")
                 .def(py::init<double>(),
                     py::arg("timestep") = 0.015)
 
@@ -63,6 +210,9 @@ namespace robot_dart {
 
                 .def("scheduler", (Scheduler & (RobotDARTSimu::*)(void)) & RobotDARTSimu::scheduler, py::return_value_policy::reference)
                 .def("schedule", &RobotDARTSimu::schedule)
+                .def("profiler", (StepProfiler & (RobotDARTSimu::*)(void)) & RobotDARTSimu::profiler, py::return_value_policy::reference)
+                .def("set_recorder", &RobotDARTSimu::set_recorder)
+                .def("recorder", &RobotDARTSimu::recorder)
 
                 .def("physics_freq", &RobotDARTSimu::physics_freq)
 
@@ -101,6 +251,20 @@ namespace robot_dart {
                     py::arg("disable") = true)
                 .def("halted_sim", &RobotDARTSimu::halted_sim)
 
+                .def("add_termination_condition", &RobotDARTSimu::add_termination_condition)
+                .def("termination_conditions", &RobotDARTSimu::termination_conditions)
+                .def("clear_termination_conditions", &RobotDARTSimu::clear_termination_conditions)
+                .def("termination_freq", &RobotDARTSimu::termination_freq)
+                .def("set_termination_freq", &RobotDARTSimu::set_termination_freq)
+                .def("terminated_by", &RobotDARTSimu::terminated_by)
+                .def("terminated", &RobotDARTSimu::terminated)
+
+                .def("save_state", (SimuState(RobotDARTSimu::*)() const) & RobotDARTSimu::save_state)
+                .def("save_state", (void (RobotDARTSimu::*)(SimuState&) const) & RobotDARTSimu::save_state)
+                .def("restore_state", &RobotDARTSimu::restore_state,
+                    py::arg("state"),
+                    py::arg("restore_controllers") = true)
+
                 .def("num_robots", &RobotDARTSimu::num_robots)
                 .def("robots", &RobotDARTSimu::robots)
                 .def("robot", &RobotDARTSimu::robot)
@@ -126,6 +290,10 @@ namespace robot_dart {
 
                 .def("set_collision_detector", &RobotDARTSimu::set_collision_detector)
                 .def("collision_detector", &RobotDARTSimu::collision_detector)
+                .def("probe_collision_detectors", &RobotDARTSimu::probe_collision_detectors,
+                    py::arg("duration") = 0.1,
+                    py::arg("tolerance") = 1e-2,
+                    py::arg("apply") = true)
 
                 .def("set_collision_mask", (void (RobotDARTSimu::*)(size_t, uint16_t)) & RobotDARTSimu::set_collision_mask)
                 .def("set_collision_mask", (void (RobotDARTSimu::*)(size_t, const std::string&, uint16_t)) & RobotDARTSimu::set_collision_mask)
@@ -138,7 +306,79 @@ namespace robot_dart {
                 .def("remove_collision_mask", (void (RobotDARTSimu::*)(size_t, const std::string&)) & RobotDARTSimu::remove_collision_mask)
                 .def("remove_collision_mask", (void (RobotDARTSimu::*)(size_t, size_t)) & RobotDARTSimu::remove_collision_mask)
 
-                .def("remove_all_collision_masks", &RobotDARTSimu::remove_all_collision_masks);
+                .def("remove_all_collision_masks", &RobotDARTSimu::remove_all_collision_masks)
+
+                .def("enable_collision_groups", &RobotDARTSimu::enable_collision_groups,
+                    py::arg("enable") = true)
+                .def("collision_groups_enabled", &RobotDARTSimu::collision_groups_enabled)
+                .def("num_collision_groups", &RobotDARTSimu::num_collision_groups)
+
+                .def("enable_sleeping", &RobotDARTSimu::enable_sleeping,
+                    py::arg("enable") = true,
+                    py::arg("velocity_threshold") = 1e-2,
+                    py::arg("time_to_sleep") = 0.5)
+                .def("sleeping_enabled", &RobotDARTSimu::sleeping_enabled)
+                .def("sleeping", &RobotDARTSimu::sleeping)
+                .def("num_sleeping", &RobotDARTSimu::num_sleeping)
+                .def("wake_up", &RobotDARTSimu::wake_up)
+                .def("wake_up_all", &RobotDARTSimu::wake_up_all);
+
+            // SimuBatch class
+            // the GIL is released while stepping, so that workers can call python controllers/descriptors
+            py::class_<SimuBatch>(m, "SimuBatch")
+                .def(py::init<size_t, double, size_t>(),
+                    py::arg("num_worlds"),
+                    py::arg("timestep") = 0.015,
+                    py::arg("num_threads") = 0)
+
+                .def("size", &SimuBatch::size)
+                .def("num_threads", &SimuBatch::num_threads)
+
+                .def("simus", &SimuBatch::simus)
+                .def("simu", &SimuBatch::simu)
+
+                .def("step", &SimuBatch::step,
+                    py::arg("reset_commands") = false,
+                    py::call_guard<py::gil_scoped_release>())
+                .def("run", &SimuBatch::run,
+                    py::arg("max_duration") = 5.,
+                    py::arg("reset_commands") = false,
+                    py::call_guard<py::gil_scoped_release>())
+
+                .def("done", (std::vector<bool>(SimuBatch::*)() const) & SimuBatch::done)
+                .def("done", (bool (SimuBatch::*)(size_t) const) & SimuBatch::done)
+                .def("num_done", &SimuBatch::num_done)
+                .def("all_done", &SimuBatch::all_done)
+                .def("terminated_by", &SimuBatch::terminated_by)
+
+                .def("set_done", &SimuBatch::set_done,
+                    py::arg("index"),
+                    py::arg("done") = true)
+                .def("reset_done", &SimuBatch::reset_done);
+
+            // PopulationEvaluator class
+            py::class_<PopulationEvaluator>(m, "PopulationEvaluator")
+                .def(py::init<const PopulationEvaluator::simu_factory_t&, double, size_t, size_t, size_t>(),
+                    py::arg("factory"),
+                    py::arg("duration"),
+                    py::arg("num_threads") = 0,
+                    py::arg("robot_index") = 0,
+                    py::arg("controller_index") = 0)
+
+                .def("num_threads", &PopulationEvaluator::num_threads)
+                .def("duration", &PopulationEvaluator::duration)
+                .def("set_duration", &PopulationEvaluator::set_duration)
+                .def("simus", &PopulationEvaluator::simus)
+
+                // the Python callbacks re-acquire the GIL when they are called
+                .def("evaluate", &PopulationEvaluator::evaluate,
+                    py::arg("params"),
+                    py::arg("descriptor"),
+                    py::call_guard<py::gil_scoped_release>())
+                .def("evaluate_fitness", &PopulationEvaluator::evaluate_fitness,
+                    py::arg("params"),
+                    py::arg("fitness"),
+                    py::call_guard<py::gil_scoped_release>());
         }
     } // namespace python
 } // namespace robot_dart
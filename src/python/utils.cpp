@@ -2,13 +2,16 @@
 
 #include <robot_dart/scheduler.hpp>
 
+#include <pybind11/stl.h>
+
 namespace robot_dart {
     namespace python {
         void py_utils(py::module& m)
         {
             using namespace robot_dart;
 
-            py::class_<Scheduler>(m, "Scheduler")
+            py::class_<Scheduler> scheduler(m, "Scheduler");
+            scheduler
                 .def(py::init<double, bool>(),
                     py::arg("dt"),
                     py::arg("sync") = false)
@@ -16,6 +19,16 @@ namespace robot_dart {
                 .def("__call__", &Scheduler::operator())
                 .def("schedule", &Scheduler::schedule)
 
+                .def("add_task", &Scheduler::add_task)
+                .def("set_task_frequency", &Scheduler::set_task_frequency)
+                .def("num_tasks", &Scheduler::num_tasks)
+                .def("running_tasks", &Scheduler::running_tasks)
+                .def("runs", &Scheduler::runs)
+                .def("task_frequency", &Scheduler::task_frequency)
+                .def("task_period", &Scheduler::task_period)
+                .def("task_effective_frequency", &Scheduler::task_effective_frequency)
+                .def("task_drift", &Scheduler::task_drift)
+
                 .def("step", &Scheduler::step)
 
                 .def("reset", &Scheduler::reset,
@@ -26,9 +39,23 @@ namespace robot_dart {
                 .def("set_sync", &Scheduler::set_sync)
                 .def("sync", &Scheduler::sync)
 
+                .def("set_spin_margin", &Scheduler::set_spin_margin)
+                .def("spin_margin", &Scheduler::spin_margin)
+                .def("sync_stats", &Scheduler::sync_stats, py::return_value_policy::reference_internal)
+                .def("reset_sync_stats", &Scheduler::reset_sync_stats)
+                .def("set_jitter_histogram", &Scheduler::set_jitter_histogram)
+
                 .def("current_time", &Scheduler::current_time)
                 .def("next_time", &Scheduler::next_time)
                 .def("dt", &Scheduler::dt);
+
+            py::class_<Scheduler::SyncStats>(scheduler, "SyncStats")
+                .def_readonly("steps", &Scheduler::SyncStats::steps)
+                .def_readonly("overruns", &Scheduler::SyncStats::overruns)
+                .def_readonly("mean_lateness", &Scheduler::SyncStats::mean_lateness)
+                .def_readonly("max_lateness", &Scheduler::SyncStats::max_lateness)
+                .def_readonly("bucket_width", &Scheduler::SyncStats::bucket_width)
+                .def_readonly("histogram", &Scheduler::SyncStats::histogram);
         }
     } // namespace python
 } // namespace robot_dart
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef ROBOT_DART_BODY_VIEW_HPP
+#define ROBOT_DART_BODY_VIEW_HPP
+
+#include <string>
+#include <vector>
+
+namespace robot_dart {
+    class Robot;
+
+    // Indices of a list of bodies in the skeleton of a robot, resolved once from their names (see Robot::body_view).
+    // The batched queries (Robot::body_poses_into, body_twists_into, body_linear_jacobians_into) go through
+    // the bodies of a view without looking up any name; the indices are resolved again only when the bodies change.
+    class BodyView {
+    public:
+        // all the bodies of the robot (same as an empty list of names)
+        BodyView() = default;
+
+        const std::vector<std::string>& body_names() const { return _body_names; }
+        bool all_bodies() const { return _body_names.empty(); }
+
+    protected:
+        friend class Robot;
+
+        std::vector<std::string> _body_names;
+        // cache (resolved by the robot)
+        mutable std::vector<std::size_t> _indices;
+        // version of the maps of the robot (see Robot::update_joint_dof_maps)
+        mutable std::size_t _version = 0;
+        mutable std::size_t _num_bodies = 0;
+    };
+} // namespace robot_dart
+
+#endif
@@ -0,0 +1,367 @@
+#include "collision_shape_cache.hpp"
+#include "utils.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+
+namespace robot_dart {
+    namespace detail {
+        struct HullFace {
+            std::array<int, 3> v;
+            Eigen::Vector3d normal;
+            double offset;
+            // points in front of the face (each point is assigned to one face only)
+            std::vector<int> outside;
+        };
+
+        HullFace hull_face(const std::vector<Eigen::Vector3d>& points, int a, int b, int c)
+        {
+            HullFace face;
+            face.v = {{a, b, c}};
+            face.normal = (points[b] - points[a]).cross(points[c] - points[a]).normalized();
+            face.offset = face.normal.dot(points[a]);
+            return face;
+        }
+
+        // gives each point to the first face it is in front of (the points behind all the faces are inside the hull)
+        void assign_outside(const std::vector<Eigen::Vector3d>& points, const std::vector<int>& candidates, std::vector<HullFace>& faces, size_t first_face, double eps)
+        {
+            for (int i : candidates) {
+                for (size_t f = first_face; f < faces.size(); f++) {
+                    if (faces[f].normal.dot(points[i]) - faces[f].offset > eps) {
+                        faces[f].outside.push_back(i);
+                        break;
+                    }
+                }
+            }
+        }
+
+        std::vector<std::array<int, 3>> convex_hull(const std::vector<Eigen::Vector3d>& points)
+        {
+            std::vector<std::array<int, 3>> triangles;
+            if (points.size() < 4)
+                return triangles;
+
+            // initial tetrahedron: two far away points, the farthest one from their line and the farthest one from their plane
+            Eigen::Vector3d min = points[0], max = points[0];
+            for (auto& p : points) {
+                min = min.cwiseMin(p);
+                max = max.cwiseMax(p);
+            }
+            // vertices of the meshes are floats
+            double eps = 1e-6 * (max - min).maxCoeff();
+
+            int i0 = 0, i1 = 0, i2 = 0, i3 = 0;
+            for (size_t i = 0; i < points.size(); i++)
+                if (points[i][0] < points[i0][0])
+                    i0 = i;
+            double best = 0.;
+            for (size_t i = 0; i < points.size(); i++) {
+                double d = (points[i] - points[i0]).squaredNorm();
+                if (d > best) {
+                    best = d;
+                    i1 = i;
+                }
+            }
+            Eigen::Vector3d dir = (points[i1] - points[i0]).normalized();
+            best = 0.;
+            for (size_t i = 0; i < points.size(); i++) {
+                Eigen::Vector3d v = points[i] - points[i0];
+                double d = (v - v.dot(dir) * dir).norm();
+                if (d > best) {
+                    best = d;
+                    i2 = i;
+                }
+            }
+            if (best < eps)
+                return triangles;
+            Eigen::Vector3d normal = (points[i1] - points[i0]).cross(points[i2] - points[i0]).normalized();
+            best = 0.;
+            for (size_t i = 0; i < points.size(); i++) {
+                double d = std::abs(normal.dot(points[i] - points[i0]));
+                if (d > best) {
+                    best = d;
+                    i3 = i;
+                }
+            }
+            if (best < eps)
+                return triangles;
+
+            // faces oriented outwards
+            Eigen::Vector3d center = (points[i0] + points[i1] + points[i2] + points[i3]) / 4.;
+            std::vector<HullFace> faces;
+            for (auto& f : std::vector<std::array<int, 3>>{{{i0, i1, i2}}, {{i0, i1, i3}}, {{i0, i2, i3}}, {{i1, i2, i3}}}) {
+                HullFace face = hull_face(points, f[0], f[1], f[2]);
+                if (face.normal.dot(center) > face.offset)
+                    face = hull_face(points, f[0], f[2], f[1]);
+                faces.push_back(face);
+            }
+            // the meshes repeat their vertices: the duplicates (and the vertices of the hull) are never outside
+            std::vector<int> candidates(points.size());
+            for (size_t i = 0; i < points.size(); i++)
+                candidates[i] = i;
+            std::sort(candidates.begin(), candidates.end(), [&points](int a, int b) { return std::lexicographical_compare(points[a].data(), points[a].data() + 3, points[b].data(), points[b].data() + 3); });
+            candidates.erase(std::unique(candidates.begin(), candidates.end(), [&points](int a, int b) { return points[a] == points[b]; }), candidates.end());
+            candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](int i) { return points[i] == points[i0] || points[i] == points[i1] || points[i] == points[i2] || points[i] == points[i3]; }), candidates.end());
+            assign_outside(points, candidates, faces, 0, eps);
+
+            // quickhull: the farthest point in front of a face replaces the faces it sees by a cone on their horizon
+            // (taking the farthest point first keeps the new faces away from the rounding errors)
+            std::vector<char> visible;
+            std::vector<size_t> stack;
+            std::map<std::pair<int, int>, size_t> edges;
+            while (true) {
+                size_t face = 0;
+                while (face < faces.size() && faces[face].outside.empty())
+                    face++;
+                if (face == faces.size())
+                    break;
+
+                int eye = faces[face].outside[0];
+                for (int i : faces[face].outside)
+                    if (faces[face].normal.dot(points[i]) > faces[face].normal.dot(points[eye]))
+                        eye = i;
+                const Eigen::Vector3d& p = points[eye];
+
+                edges.clear();
+                for (size_t f = 0; f < faces.size(); f++)
+                    for (int e = 0; e < 3; e++)
+                        edges[std::make_pair(faces[f].v[e], faces[f].v[(e + 1) % 3])] = f;
+
+                // the visible faces are grown from this face, so that they stay connected
+                visible.assign(faces.size(), 0);
+                visible[face] = 1;
+                stack.assign(1, face);
+                while (!stack.empty()) {
+                    size_t f = stack.back();
+                    stack.pop_back();
+                    for (int e = 0; e < 3; e++) {
+                        auto it = edges.find(std::make_pair(faces[f].v[(e + 1) % 3], faces[f].v[e]));
+                        if (it != edges.end() && !visible[it->second] && faces[it->second].normal.dot(p) - faces[it->second].offset > eps) {
+                            visible[it->second] = 1;
+                            stack.push_back(it->second);
+                        }
+                    }
+                }
+
+                // the faces almost coplanar with the eye or that would make a concave edge with the cone are removed too
+                for (bool changed = true; changed;) {
+                    changed = false;
+                    for (size_t f = 0; f < faces.size(); f++) {
+                        if (!visible[f])
+                            continue;
+                        for (int e = 0; e < 3; e++) {
+                            int a = faces[f].v[e], b = faces[f].v[(e + 1) % 3];
+                            auto it = edges.find(std::make_pair(b, a));
+                            if (it == edges.end() || visible[it->second])
+                                continue;
+                            const HullFace& other = faces[it->second];
+                            int c = other.v[0] + other.v[1] + other.v[2] - a - b;
+                            HullFace side = hull_face(points, a, b, eye);
+                            if (other.normal.dot(p) - other.offset > -eps || side.normal.dot(points[c]) - side.offset > eps) {
+                                visible[it->second] = 1;
+                                changed = true;
+                            }
+                        }
+                    }
+                }
+
+                std::vector<HullFace> new_faces;
+                std::vector<HullFace> cone;
+                candidates.clear();
+                new_faces.reserve(faces.size() + 8);
+                for (size_t f = 0; f < faces.size(); f++) {
+                    if (!visible[f]) {
+                        new_faces.push_back(std::move(faces[f]));
+                        continue;
+                    }
+                    // horizon: the edges shared with a face that is not visible (same orientation as the removed face)
+                    for (int e = 0; e < 3; e++) {
+                        int a = faces[f].v[e], b = faces[f].v[(e + 1) % 3];
+                        auto it = edges.find(std::make_pair(b, a));
+                        if (it == edges.end() || !visible[it->second])
+                            cone.push_back(hull_face(points, a, b, eye));
+                    }
+                    for (int i : faces[f].outside)
+                        if (i != eye)
+                            candidates.push_back(i);
+                }
+                size_t first_cone = new_faces.size();
+                for (auto& c : cone)
+                    new_faces.push_back(std::move(c));
+                faces.swap(new_faces);
+                assign_outside(points, candidates, faces, first_cone, eps);
+            }
+
+            for (auto& face : faces)
+                triangles.push_back(face.v);
+            return triangles;
+        }
+
+        bool write_stl(const std::string& file, const std::vector<Eigen::Vector3d>& points, const std::vector<std::array<int, 3>>& triangles)
+        {
+            std::ofstream ofs(file, std::ios::binary);
+            if (!ofs)
+                return false;
+
+            char header[80] = "robot_dart convex hull";
+            ofs.write(header, 80);
+            uint32_t num_triangles = triangles.size();
+            ofs.write(reinterpret_cast<const char*>(&num_triangles), sizeof(num_triangles));
+            for (auto& t : triangles) {
+                Eigen::Vector3f normal = (points[t[1]] - points[t[0]]).cross(points[t[2]] - points[t[0]]).normalized().cast<float>();
+                ofs.write(reinterpret_cast<const char*>(normal.data()), 3 * sizeof(float));
+                for (int i = 0; i < 3; i++) {
+                    Eigen::Vector3f v = points[t[i]].cast<float>();
+                    ofs.write(reinterpret_cast<const char*>(v.data()), 3 * sizeof(float));
+                }
+                uint16_t attributes = 0;
+                ofs.write(reinterpret_cast<const char*>(&attributes), sizeof(attributes));
+            }
+            return static_cast<bool>(ofs);
+        }
+    } // namespace detail
+
+    CollisionShapeCache& CollisionShapeCache::instance()
+    {
+        static CollisionShapeCache cache;
+        return cache;
+    }
+
+    CollisionShapeCache::CollisionShapeCache()
+    {
+        const char* xdg = std::getenv("XDG_CACHE_HOME");
+        const char* home = std::getenv("HOME");
+        if (xdg && xdg[0] != '\0')
+            _directory = std::string(xdg) + "/robot_dart/collision";
+        else if (home && home[0] != '\0')
+            _directory = std::string(home) + "/.cache/robot_dart/collision";
+        else
+            _directory = "/tmp/robot_dart/collision";
+    }
+
+    void CollisionShapeCache::set_directory(const std::string& directory)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _directory = directory;
+    }
+
+    std::string CollisionShapeCache::directory() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _directory;
+    }
+
+    std::shared_ptr<dart::dynamics::MeshShape> CollisionShapeCache::convex_hull(const std::shared_ptr<dart::dynamics::MeshShape>& mesh)
+    {
+        if (!mesh || !mesh->getMesh())
+            return nullptr;
+
+        uint64_t hash = mesh_hash(mesh->getMesh());
+        Eigen::Vector3d scale = mesh->getScale();
+        auto key = std::make_tuple(hash, scale[0], scale[1], scale[2]);
+
+        std::string directory, file;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _hulls.find(key);
+            if (it != _hulls.end())
+                return it->second;
+            directory = _directory;
+            file = _file(hash);
+        }
+
+        // the hull is computed and loaded without holding the lock: two threads might compute the same hull, but the
+        // file is replaced atomically and only one of the shapes is kept
+        namespace fs = boost::filesystem;
+        boost::system::error_code error;
+        if (!fs::exists(file, error)) {
+            std::vector<Eigen::Vector3d> points = mesh_vertices(mesh->getMesh());
+            auto triangles = detail::convex_hull(points);
+            if (triangles.empty())
+                return nullptr;
+
+            // written under another name first: other processes might read the file
+            fs::path tmp_file = fs::path(file).parent_path() / fs::unique_path("%%%%-%%%%-%%%%-%%%%.tmp");
+            fs::create_directories(directory, error);
+            bool ok = !error && detail::write_stl(tmp_file.string(), points, triangles);
+            if (ok)
+                fs::rename(tmp_file, file, error);
+            ok = ok && !error;
+            ROBOT_DART_WARNING(!ok, "Cannot write the convex hull to " + file);
+            if (!ok) {
+                fs::remove(tmp_file, error);
+                return nullptr;
+            }
+        }
+
+        const aiScene* hull = dart::dynamics::MeshShape::loadMesh(file);
+        if (!hull)
+            return nullptr;
+        auto shape = std::make_shared<dart::dynamics::MeshShape>(scale, hull, dart::common::Uri::createFromPath(file));
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        // another thread might have inserted the same hull in the meantime
+        return _hulls.insert(std::make_pair(key, shape)).first->second;
+    }
+
+    void CollisionShapeCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _hulls.clear();
+    }
+
+    size_t CollisionShapeCache::size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _hulls.size();
+    }
+
+    uint64_t CollisionShapeCache::mesh_hash(const aiScene* scene)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        auto add = [&hash](const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+        };
+
+        for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+            const aiMesh* mesh = scene->mMeshes[m];
+            add(&mesh->mNumVertices, sizeof(mesh->mNumVertices));
+            for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+                const aiVector3D& v = mesh->mVertices[i];
+                add(&v.x, sizeof(v.x));
+                add(&v.y, sizeof(v.y));
+                add(&v.z, sizeof(v.z));
+            }
+        }
+        return hash;
+    }
+
+    std::vector<Eigen::Vector3d> CollisionShapeCache::mesh_vertices(const aiScene* scene)
+    {
+        std::vector<Eigen::Vector3d> points;
+        for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+            const aiMesh* mesh = scene->mMeshes[m];
+            for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+                points.push_back(Eigen::Vector3d(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z));
+        }
+        return points;
+    }
+
+    std::string CollisionShapeCache::_file(uint64_t hash) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.stl", static_cast<unsigned long long>(hash));
+        return _directory + "/" + name;
+    }
+} // namespace robot_dart
@@ -0,0 +1,57 @@
+#ifndef ROBOT_DART_COLLISION_SHAPE_CACHE_HPP
+#define ROBOT_DART_COLLISION_SHAPE_CACHE_HPP
+
+#include <dart/dynamics/MeshShape.hpp>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace robot_dart {
+    // Process-wide cache of the convex hulls of the collision meshes (see Robot::simplify_collision_shapes()).
+    // A hull is computed once: it is written to disk as a binary STL file named after a hash of the vertices of the mesh
+    // (directory()) and shared in memory by all the robots, so loading the same meshes again only reads the (small) hull files.
+    class CollisionShapeCache {
+    public:
+        static CollisionShapeCache& instance();
+
+        // default: $XDG_CACHE_HOME/robot_dart/collision, $HOME/.cache/robot_dart/collision or /tmp/robot_dart/collision
+        void set_directory(const std::string& directory);
+        std::string directory() const;
+
+        // hull of the vertices of the mesh, with the same scale; nullptr if the mesh is flat (or cannot be written to disk)
+        std::shared_ptr<dart::dynamics::MeshShape> convex_hull(const std::shared_ptr<dart::dynamics::MeshShape>& mesh);
+
+        // memory only (the files are kept)
+        void clear();
+        size_t size() const;
+
+        // FNV-1a hash of the vertices of all the meshes of the scene (the ones used by the collision detectors)
+        static uint64_t mesh_hash(const aiScene* scene);
+        // vertices of all the meshes of the scene (without the scale of the MeshShape)
+        static std::vector<Eigen::Vector3d> mesh_vertices(const aiScene* scene);
+
+    protected:
+        CollisionShapeCache();
+
+        std::string _file(uint64_t hash) const;
+
+        mutable std::mutex _mutex;
+        std::string _directory;
+        // (hash, scale) -> hull; the hulls are shared like the meshes of cloned robots
+        std::map<std::tuple<uint64_t, double, double, double>, std::shared_ptr<dart::dynamics::MeshShape>> _hulls;
+    };
+
+    namespace detail {
+        // triangles (counter-clockwise seen from outside) of the convex hull of the points; empty if the points are (almost) flat
+        std::vector<std::array<int, 3>> convex_hull(const std::vector<Eigen::Vector3d>& points);
+        bool write_stl(const std::string& file, const std::vector<Eigen::Vector3d>& points, const std::vector<std::array<int, 3>>& triangles);
+    } // namespace detail
+} // namespace robot_dart
+
+#endif
@@ -2,6 +2,8 @@
 #include "robot_dart/robot.hpp"
 #include "robot_dart/utils.hpp"
 
+#include <dart/dynamics/DegreeOfFreedom.hpp>
+
 namespace robot_dart {
     namespace control {
         PDControl::PDControl() : RobotControl() {}
@@ -17,20 +19,31 @@ namespace robot_dart {
                 set_pd(10., 0.1);
         }
 
-        Eigen::VectorXd PDControl::calculate(double)
+        Eigen::VectorXd PDControl::calculate(double t)
         {
-            ROBOT_DART_ASSERT(_control_dof == _ctrl.size(), "PDControl: Controller parameters size is not the same as DOFs of the robot", Eigen::VectorXd::Zero(_control_dof));
-            auto robot = _robot.lock();
-            Eigen::VectorXd& target_positions = _ctrl;
+            Eigen::VectorXd commands(_control_dof);
+            calculate_into(t, commands);
+            return commands;
+        }
 
-            Eigen::VectorXd q = robot->positions(_controllable_dofs);
-            Eigen::VectorXd dq = robot->velocities(_controllable_dofs);
+        void PDControl::calculate_into(double, Eigen::VectorXd& commands)
+        {
+            commands.resize(_control_dof);
+            if (_control_dof != _ctrl.size()) {
+                commands.setZero();
+                ROBOT_DART_ASSERT(false, "PDControl: Controller parameters size is not the same as DOFs of the robot", );
+            }
+            auto robot = _robot.lock();
+            auto skel = robot->skeleton();
+            const auto& indices = robot->dof_indices(_controllable_dof_view);
+            const Eigen::VectorXd& target_positions = _ctrl;
 
             /// Compute the simplest PD controller output:
             /// P gain * (target position - current position) + D gain * (0 - current velocity)
-            Eigen::VectorXd commands = _Kp.array() * (target_positions.array() - q.array()) - _Kd.array() * dq.array();
-
-            return commands;
+            for (int i = 0; i < _control_dof; i++) {
+                auto dof = skel->getDof(indices[i]);
+                commands(i) = _Kp(i) * (target_positions(i) - dof->getPosition()) - _Kd(i) * dof->getVelocity();
+            }
         }
 
         void PDControl::set_pd(double Kp, double Kd)
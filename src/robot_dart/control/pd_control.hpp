@@ -17,6 +17,7 @@ namespace robot_dart {
 
             void configure() override;
             Eigen::VectorXd calculate(double) override;
+            void calculate_into(double, Eigen::VectorXd& commands) override;
 
             void set_pd(double p, double d);
             void set_pd(const Eigen::VectorXd& p, const Eigen::VectorXd& d);
@@ -43,15 +43,21 @@ namespace robot_dart {
             Eigen::VectorXd calculate(double t) override
             {
                 ROBOT_DART_ASSERT(_control_dof == _policy.output_size(), "PolicyControl: Policy output size is not the same as DOFs of the robot", Eigen::VectorXd::Zero(_control_dof));
-                if (_first || _full_dt || (t - _prev_time - _dt) >= _threshold) {
-                    _prev_commands = _policy.query(_robot.lock(), t);
+                _query(t);
 
-                    _first = false;
-                    _prev_time = t;
-                    _i++;
+                return _prev_commands;
+            }
+
+            // the policy itself might allocate when it is queried, but not in-between queries
+            void calculate_into(double t, Eigen::VectorXd& commands) override
+            {
+                if (_control_dof != _policy.output_size()) {
+                    commands.setZero(_control_dof);
+                    ROBOT_DART_ASSERT(false, "PolicyControl: Policy output size is not the same as DOFs of the robot", );
                 }
+                _query(t);
 
-                return _prev_commands;
+                commands = _prev_commands;
             }
 
             std::shared_ptr<RobotControl> clone() const override
@@ -59,7 +65,40 @@ namespace robot_dart {
                 return std::make_shared<PolicyControl>(*this);
             }
 
+            size_t state_size() const override { return 3 + _control_dof; }
+
+            void save_state(double* state) const override
+            {
+                state[0] = _first;
+                state[1] = _prev_time;
+                state[2] = _i;
+                // the previous commands do not exist before the first query
+                if (_prev_commands.size() == _control_dof)
+                    Eigen::Map<Eigen::VectorXd>(state + 3, _control_dof) = _prev_commands;
+                else
+                    Eigen::Map<Eigen::VectorXd>(state + 3, _control_dof).setZero();
+            }
+
+            void restore_state(const double* state) override
+            {
+                _first = state[0] != 0.;
+                _prev_time = state[1];
+                _i = static_cast<int>(state[2]);
+                _prev_commands = Eigen::Map<const Eigen::VectorXd>(state + 3, _control_dof);
+            }
+
         protected:
+            void _query(double t)
+            {
+                if (_first || _full_dt || (t - _prev_time - _dt) >= _threshold) {
+                    _prev_commands = _policy.query(_robot.lock(), t);
+
+                    _first = false;
+                    _prev_time = t;
+                    _i++;
+                }
+            }
+
             int _i;
             Policy _policy;
             double _dt, _prev_time, _threshold;
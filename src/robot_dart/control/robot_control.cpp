@@ -29,8 +29,12 @@ namespace robot_dart {
             _dof = robot->skeleton()->getNumDofs();
 
             if (_check_free && robot->free()) {
-                auto names = robot->dof_names(true, true, true);
-                _controllable_dofs = std::vector<std::string>(names.begin() + 6, names.end());
+                // sliced again only when the DoF lists of the robot changed (not at each set_parameters())
+                if (_controllable_dofs_version != robot->dof_names_version()) {
+                    const auto& names = robot->dof_names(true, true, true);
+                    _controllable_dofs.assign(names.begin() + 6, names.end());
+                    _controllable_dofs_version = robot->dof_names_version();
+                }
             }
             else if (_controllable_dofs.empty()) {
                 // we cannot control mimic, locked and passive joints
@@ -38,6 +42,9 @@ namespace robot_dart {
             }
 
             _control_dof = _controllable_dofs.size();
+            // re-parameterizations do not change the DoFs: keep the view (it is resolved again if the robot changes)
+            if (_controllable_dof_view.all_dofs() || _controllable_dof_view.dof_names() != _controllable_dofs)
+                _controllable_dof_view = robot->dof_view(_controllable_dofs);
 
             configure();
         }
@@ -67,6 +74,8 @@ namespace robot_dart {
 
         const std::vector<std::string>& RobotControl::controllable_dofs() const { return _controllable_dofs; }
 
+        const DofView& RobotControl::controllable_dof_view() const { return _controllable_dof_view; }
+
         double RobotControl::weight() const
         {
             return _weight;
@@ -8,6 +8,8 @@
 
 #include <dart/config.hpp>
 
+#include <robot_dart/dof_view.hpp>
+
 namespace robot_dart {
     class Robot;
 
@@ -32,6 +34,8 @@ namespace robot_dart {
             bool active() const;
 
             const std::vector<std::string>& controllable_dofs() const;
+            // controllable DoFs with their indices resolved (see DofView)
+            const DofView& controllable_dof_view() const;
 
             double weight() const;
             void set_weight(double weight);
@@ -39,8 +43,18 @@ namespace robot_dart {
             virtual void configure() = 0;
             // TO-DO: Maybe make this const?
             virtual Eigen::VectorXd calculate(double t) = 0;
+            // same as calculate() but writes the commands of the controllable DoFs into a buffer
+            // that is kept by the caller (resized only if needed), used by Robot::update();
+            // the default implementation copies the output of calculate(): override it to avoid the allocations
+            virtual void calculate_into(double t, Eigen::VectorXd& commands) { commands = calculate(t); }
             virtual std::shared_ptr<RobotControl> clone() const = 0;
 
+            // Internal state of the controller, used by RobotDARTSimu::save_state()/restore_state()
+            // Controllers that keep state between calls to calculate() should override all three
+            virtual size_t state_size() const { return 0; }
+            virtual void save_state(double*) const {}
+            virtual void restore_state(const double*) {}
+
         protected:
             std::weak_ptr<Robot> _robot;
             Eigen::VectorXd _ctrl;
@@ -48,6 +62,9 @@ namespace robot_dart {
             bool _active, _check_free = false;
             int _dof, _control_dof;
             std::vector<std::string> _controllable_dofs;
+            // Robot::dof_names_version() of the lists _controllable_dofs was sliced from (free robots)
+            size_t _controllable_dofs_version = 0;
+            DofView _controllable_dof_view;
         };
     } // namespace control
 } // namespace robot_dart
@@ -20,6 +20,15 @@ namespace robot_dart {
             return _ctrl;
         }
 
+        void SimpleControl::calculate_into(double, Eigen::VectorXd& commands)
+        {
+            if (_control_dof != _ctrl.size()) {
+                commands.setZero(_control_dof);
+                ROBOT_DART_ASSERT(false, "SimpleControl: Controller parameters size is not the same as DOFs of the robot", );
+            }
+            commands = _ctrl;
+        }
+
         std::shared_ptr<RobotControl> SimpleControl::clone() const
         {
             return std::make_shared<SimpleControl>(*this);
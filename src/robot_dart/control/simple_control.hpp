@@ -14,6 +14,7 @@ namespace robot_dart {
 
             void configure() override;
             Eigen::VectorXd calculate(double) override;
+            void calculate_into(double, Eigen::VectorXd& commands) override;
             std::shared_ptr<RobotControl> clone() const override;
         };
     } // namespace control
@@ -0,0 +1,71 @@
+#include "damage_variants.hpp"
+#include "utils.hpp"
+
+#include <limits>
+#include <sstream>
+
+namespace robot_dart {
+    DamageVariants::DamageVariants(const std::shared_ptr<Robot>& base) : _base(base), _base_damages(base->damages()), _joint_map(base->joint_map()), _num_joints(base->num_joints()) {}
+
+    std::shared_ptr<Robot> DamageVariants::robot(const std::vector<RobotDamage>& damages, const std::string& name)
+    {
+        return _variant(damages)->clone(name);
+    }
+
+    void DamageVariants::preload(const std::vector<RobotDamage>& damages)
+    {
+        _variant(damages);
+    }
+
+    size_t DamageVariants::size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _variants.size();
+    }
+
+    void DamageVariants::clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _variants.clear();
+    }
+
+    std::string DamageVariants::signature(const std::vector<RobotDamage>& damages) const
+    {
+        std::ostringstream sig;
+        sig.precision(std::numeric_limits<double>::max_digits10);
+        for (auto& dmg : damages) {
+            size_t index = dmg.joint_index;
+            if (dmg.joint_index < 0) {
+                auto it = _joint_map.find(dmg.data);
+                ROBOT_DART_EXCEPTION_ASSERT(it != _joint_map.end(), "DamageVariants: " + dmg.data + " is not a joint of the robot");
+                index = it->second;
+            }
+            ROBOT_DART_EXCEPTION_ASSERT(index < _num_joints, "DamageVariants: joint index out of bounds");
+
+            sig << dmg.type << ":" << index;
+            if (dmg.type == "blocked_joint" && dmg.extra)
+                sig << "=" << *((double*)dmg.extra);
+            sig << ";";
+        }
+        return sig.str();
+    }
+
+    std::shared_ptr<RobotPrototype> DamageVariants::_variant(const std::vector<RobotDamage>& damages)
+    {
+        std::string key = signature(damages);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _variants.find(key);
+        if (it != _variants.end())
+            return it->second;
+
+        // the damages of the base robot are already applied to the clone
+        auto robot = _base.clone();
+        robot->_set_damages(damages);
+        robot->_damages.insert(robot->_damages.begin(), _base_damages.begin(), _base_damages.end());
+
+        auto variant = std::make_shared<RobotPrototype>(robot);
+        _variants[key] = variant;
+        return variant;
+    }
+} // namespace robot_dart
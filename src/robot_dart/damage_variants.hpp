@@ -0,0 +1,42 @@
+#ifndef ROBOT_DART_DAMAGE_VARIANTS_HPP
+#define ROBOT_DART_DAMAGE_VARIANTS_HPP
+
+#include <robot_dart/robot_prototype.hpp>
+
+#include <mutex>
+
+namespace robot_dart {
+    // Damaged versions of a robot for damage-recovery experiments.
+    // The base robot is loaded once; each set of damages is applied once to a clone of it and the result is kept
+    // as a prototype, keyed by the signature of the damages (the damages by name and by index of the same joint
+    // share the same variant). Later requests of the same damages only clone the prototype (see RobotPrototype).
+    class DamageVariants {
+    public:
+        // the damages of the base robot are applied before the damages of each variant
+        DamageVariants(const std::shared_ptr<Robot>& base);
+
+        // thread-safe; name == "" keeps the name of the base robot
+        std::shared_ptr<Robot> robot(const std::vector<RobotDamage>& damages, const std::string& name = "");
+        // builds the variant without cloning it (e.g., before a sweep)
+        void preload(const std::vector<RobotDamage>& damages);
+
+        size_t size() const;
+        void clear();
+
+        // the damages in order, with the joints given by index (e.g., "blocked_joint:3=0.5;free_joint:7;")
+        std::string signature(const std::vector<RobotDamage>& damages) const;
+
+    protected:
+        std::shared_ptr<RobotPrototype> _variant(const std::vector<RobotDamage>& damages);
+
+        RobotPrototype _base;
+        std::vector<RobotDamage> _base_damages;
+        std::unordered_map<std::string, size_t> _joint_map;
+        size_t _num_joints;
+
+        mutable std::mutex _mutex;
+        std::unordered_map<std::string, std::shared_ptr<RobotPrototype>> _variants;
+    };
+} // namespace robot_dart
+
+#endif
@@ -0,0 +1,128 @@
+#include <robot_dart/descriptor/sensor_buffer.hpp>
+
+#include <robot_dart/robot_dart_simu.hpp>
+#include <robot_dart/utils.hpp>
+
+#include <dart/collision/CollisionObject.hpp>
+#include <dart/dynamics/BodyNode.hpp>
+#include <dart/dynamics/ShapeNode.hpp>
+
+#include <algorithm>
+
+namespace robot_dart {
+    namespace descriptor {
+        namespace detail {
+            const dart::dynamics::BodyNode* contact_body(const dart::collision::CollisionObject* object)
+            {
+                auto shape_node = object ? object->getShapeFrame()->asShapeNode() : nullptr;
+                return shape_node ? shape_node->getBodyNodePtr().get() : nullptr;
+            }
+        } // namespace detail
+
+        SensorBuffer::SensorBuffer(RobotDARTSimu* simu, size_t desc_dump, size_t max_contacts) : BaseDescriptor(simu, desc_dump)
+        {
+            set_max_contacts(max_contacts);
+        }
+
+        void SensorBuffer::operator()()
+        {
+            for (size_t i = 0; i < _ft_robots.size(); i++)
+                _wrenches.col(i) = _ft_robots[i]->force_torque(_ft_joints[i]).second;
+
+            _num_contacts = 0;
+            _dropped_contacts = 0;
+            _body_forces.setZero();
+            std::fill(_body_contacts.begin(), _body_contacts.end(), 0);
+            if (_contact_bodies.empty())
+                return;
+
+            // the forces of the contacts are filled by the constraint solver during the step
+            const auto& result = _simu->world()->getLastCollisionResult();
+            for (size_t c = 0; c < result.getNumContacts(); c++) {
+                const auto& contact = result.getContact(c);
+                auto body1 = detail::contact_body(contact.collisionObject1);
+                auto body2 = detail::contact_body(contact.collisionObject2);
+                // few bodies: a linear search is faster than a map
+                for (size_t s = 0; s < _contact_bodies.size(); s++) {
+                    // DART gives the normal (from the second to the first body) and the force acting on the first body
+                    if (_contact_bodies[s] == body1)
+                        _record(s, contact.point, contact.normal, contact.force);
+                    if (_contact_bodies[s] == body2)
+                        _record(s, contact.point, -contact.normal, -contact.force);
+                }
+            }
+        }
+
+        size_t SensorBuffer::add_force_torque(const std::shared_ptr<Robot>& robot, const std::string& joint_name)
+        {
+            ROBOT_DART_EXCEPTION_ASSERT(robot, "SensorBuffer: no robot given");
+            auto it = robot->joint_map().find(joint_name);
+            ROBOT_DART_EXCEPTION_ASSERT(it != robot->joint_map().end(), "SensorBuffer: " + joint_name + " is not a joint of " + robot->name());
+            return add_force_torque(robot, it->second);
+        }
+
+        size_t SensorBuffer::add_force_torque(const std::shared_ptr<Robot>& robot, size_t joint_index)
+        {
+            ROBOT_DART_EXCEPTION_ASSERT(robot, "SensorBuffer: no robot given");
+            ROBOT_DART_EXCEPTION_ASSERT(joint_index < robot->num_joints(), "SensorBuffer: joint index out of bounds");
+            _ft_robots.push_back(robot);
+            _ft_joints.push_back(joint_index);
+            _wrenches.conservativeResize(Eigen::NoChange, _ft_robots.size());
+            _wrenches.rightCols<1>().setZero();
+            return _ft_robots.size() - 1;
+        }
+
+        size_t SensorBuffer::add_contact_body(const std::shared_ptr<Robot>& robot, const std::string& body_name)
+        {
+            ROBOT_DART_EXCEPTION_ASSERT(robot, "SensorBuffer: no robot given");
+            auto bd = robot->skeleton()->getBodyNode(body_name);
+            ROBOT_DART_EXCEPTION_ASSERT(bd != nullptr, "SensorBuffer: " + body_name + " is not a body of " + robot->name());
+            _contact_robots.push_back(robot);
+            _contact_bodies.push_back(bd);
+            _body_forces.conservativeResize(Eigen::NoChange, _contact_bodies.size());
+            _body_forces.rightCols<1>().setZero();
+            _body_contacts.push_back(0);
+            return _contact_bodies.size() - 1;
+        }
+
+        void SensorBuffer::clear()
+        {
+            _ft_robots.clear();
+            _ft_joints.clear();
+            _wrenches.resize(Eigen::NoChange, 0);
+
+            _contact_robots.clear();
+            _contact_bodies.clear();
+            _body_forces.resize(Eigen::NoChange, 0);
+            _body_contacts.clear();
+            _num_contacts = 0;
+            _dropped_contacts = 0;
+        }
+
+        void SensorBuffer::set_max_contacts(size_t max_contacts)
+        {
+            _contact_points = Eigen::Matrix3Xd::Zero(3, max_contacts);
+            _contact_normals = Eigen::Matrix3Xd::Zero(3, max_contacts);
+            _contact_forces = Eigen::Matrix3Xd::Zero(3, max_contacts);
+            _contact_sensors.assign(max_contacts, 0);
+            _num_contacts = 0;
+            _dropped_contacts = 0;
+        }
+
+        void SensorBuffer::_record(size_t sensor, const Eigen::Vector3d& point, const Eigen::Vector3d& normal, const Eigen::Vector3d& force)
+        {
+            _body_forces.col(sensor) += force;
+            _body_contacts[sensor]++;
+
+            if (_num_contacts == max_contacts()) {
+                _dropped_contacts++;
+                return;
+            }
+            _contact_points.col(_num_contacts) = point;
+            _contact_normals.col(_num_contacts) = normal;
+            _contact_forces.col(_num_contacts) = force;
+            _contact_sensors[_num_contacts] = sensor;
+            _num_contacts++;
+        }
+    } // namespace descriptor
+} // namespace robot_dart
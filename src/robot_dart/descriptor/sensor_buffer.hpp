@@ -0,0 +1,80 @@
+#ifndef ROBOT_DART_DESCRIPTOR_SENSOR_BUFFER_HPP
+#define ROBOT_DART_DESCRIPTOR_SENSOR_BUFFER_HPP
+
+#include <robot_dart/descriptor/base_descriptor.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace dart {
+    namespace dynamics {
+        class BodyNode;
+    }
+} // namespace dart
+
+namespace robot_dart {
+    namespace descriptor {
+        // Force/torque and contact sensors read after the physics step (every desc_dump steps).
+        // The joints and bodies are registered once; the readings are written into preallocated arrays
+        // (one column per sensor/contact), so reading them does not traverse the world or allocate.
+        struct SensorBuffer : public BaseDescriptor {
+        public:
+            // max_contacts: capacity of the contact arrays (the contacts beyond are counted in dropped_contacts())
+            SensorBuffer(RobotDARTSimu* simu, size_t desc_dump = 1, size_t max_contacts = 256);
+
+            void operator()() override;
+
+            // registration (returns the index of the sensor); the robots are kept alive by the buffer
+            size_t add_force_torque(const std::shared_ptr<Robot>& robot, const std::string& joint_name);
+            size_t add_force_torque(const std::shared_ptr<Robot>& robot, size_t joint_index);
+            size_t add_contact_body(const std::shared_ptr<Robot>& robot, const std::string& body_name);
+            void clear();
+
+            size_t num_force_torques() const { return _ft_robots.size(); }
+            size_t num_contact_bodies() const { return _contact_bodies.size(); }
+            size_t max_contacts() const { return _contact_points.cols(); }
+            void set_max_contacts(size_t max_contacts);
+
+            // force/torque sensors: wrench applied by the child body on the joint, in the frame of the child body
+            // (same as Robot::force_torque(joint_index).second), one column per sensor
+            const Eigen::Matrix<double, 6, Eigen::Dynamic>& wrenches() const { return _wrenches; }
+
+            // contacts of the registered bodies in the last step, in the world frame; only the first num_contacts() columns are valid
+            // the normals and forces are the ones acting on the registered body (a contact between two registered bodies appears twice)
+            size_t num_contacts() const { return _num_contacts; }
+            size_t dropped_contacts() const { return _dropped_contacts; }
+            const Eigen::Matrix3Xd& contact_points() const { return _contact_points; }
+            const Eigen::Matrix3Xd& contact_normals() const { return _contact_normals; }
+            const Eigen::Matrix3Xd& contact_forces() const { return _contact_forces; }
+            // index of the contact body sensor of each contact
+            const std::vector<size_t>& contact_sensors() const { return _contact_sensors; }
+
+            // per contact body sensor: sum of the contact forces and number of contacts (including the dropped ones)
+            const Eigen::Matrix3Xd& body_contact_forces() const { return _body_forces; }
+            const std::vector<size_t>& body_num_contacts() const { return _body_contacts; }
+
+        protected:
+            void _record(size_t sensor, const Eigen::Vector3d& point, const Eigen::Vector3d& normal, const Eigen::Vector3d& force);
+
+            // force/torque sensors
+            std::vector<std::shared_ptr<Robot>> _ft_robots;
+            std::vector<size_t> _ft_joints;
+            Eigen::Matrix<double, 6, Eigen::Dynamic> _wrenches;
+
+            // contact sensors
+            std::vector<std::shared_ptr<Robot>> _contact_robots;
+            std::vector<const dart::dynamics::BodyNode*> _contact_bodies;
+            Eigen::Matrix3Xd _body_forces;
+            std::vector<size_t> _body_contacts;
+
+            size_t _num_contacts = 0, _dropped_contacts = 0;
+            Eigen::Matrix3Xd _contact_points, _contact_normals, _contact_forces;
+            std::vector<size_t> _contact_sensors;
+        };
+    } // namespace descriptor
+} // namespace robot_dart
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef ROBOT_DART_DOF_VIEW_HPP
+#define ROBOT_DART_DOF_VIEW_HPP
+
+#include <string>
+#include <vector>
+
+namespace robot_dart {
+    class Robot;
+
+    // Indices of a list of DoFs in the skeleton of a robot, resolved once from their names (see Robot::dof_view).
+    // Reading/writing the state of a robot through a view does not look up any name;
+    // the indices are resolved again only when the DoFs of the robot change (update_joint_dof_maps).
+    class DofView {
+    public:
+        // all the DoFs of the robot (same as an empty list of names)
+        DofView() = default;
+
+        const std::vector<std::string>& dof_names() const { return _dof_names; }
+        bool all_dofs() const { return _dof_names.empty(); }
+
+    protected:
+        friend class Robot;
+
+        std::vector<std::string> _dof_names;
+        // cache (resolved by the robot)
+        mutable std::vector<std::size_t> _indices;
+        // version of the maps of the robot (see Robot::update_joint_dof_maps)
+        mutable std::size_t _version = 0;
+    };
+} // namespace robot_dart
+
+#endif
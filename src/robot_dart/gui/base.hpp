@@ -18,6 +18,8 @@ namespace robot_dart {
             virtual bool done() const { return false; }
 
             virtual void refresh() {}
+            // block until the rendering started by refresh() is completed (only asynchronous graphics need it)
+            virtual void finish() {}
 
             virtual void set_render_period(double) {}
 
@@ -250,7 +250,7 @@ namespace robot_dart {
 
                     /* Draw debug */
                     if (draw_debug) {
-                        std::vector<std::pair<dart::dynamics::BodyNode*, double>> axes = simu->gui_data()->drawing_axes();
+                        const auto& axes = simu->gui_data()->drawing_axes();
                         for (auto& axis : axes) {
                             Magnum::Matrix4 world_transform = Magnum::Matrix4(Magnum::Matrix4d(axis.first->getWorldTransform().matrix()));
                             Magnum::Matrix4 scaling = Magnum::Matrix4::scaling(Magnum::Vector3(axis.second, axis.second, axis.second));
@@ -0,0 +1,175 @@
+#include "pipelined_windowless_graphics.hpp"
+
+#include <robot_dart/gui/magnum/base_graphics.hpp>
+#include <robot_dart/gui/magnum/gs/helper.hpp>
+#include <robot_dart/utils.hpp>
+
+namespace robot_dart {
+    namespace gui {
+        namespace magnum {
+            PipelinedWindowlessGraphics::PipelinedWindowlessGraphics(RobotDARTSimu* simu, const GraphicsConfiguration& configuration) : _simu(simu)
+            {
+                // we should not synchronize by default if we want windowless graphics (usually used only for sensors)
+                simu->scheduler().set_sync(false);
+
+                GraphicsConfiguration config = configuration;
+                ROBOT_DART_WARNING(config.draw_debug, "PipelinedWindowlessGraphics: debug drawing is not supported and will be disabled");
+                config.draw_debug = false;
+
+                _thread = std::thread(&PipelinedWindowlessGraphics::_render_loop, this, config);
+
+                // wait until the application (and its GL context) is created
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cv.wait(lock, [this] { return _ready; });
+            }
+
+            PipelinedWindowlessGraphics::~PipelinedWindowlessGraphics()
+            {
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _cv.wait(lock, [this] { return !_drawing; });
+                    _stop = true;
+                }
+                _cv.notify_all();
+                _thread.join();
+            }
+
+            void PipelinedWindowlessGraphics::refresh()
+            {
+                if (!_enabled)
+                    return;
+
+                std::unique_lock<std::mutex> lock(_mutex);
+                // only one frame in flight
+                _cv.wait(lock, [this] { return !_drawing; });
+                _drawing = true;
+                _synced = false;
+                _sync_requested = true;
+                _cv.notify_all();
+
+                // the physics can continue once the transforms are copied
+                _cv.wait(lock, [this] { return _synced; });
+            }
+
+            void PipelinedWindowlessGraphics::finish()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cv.wait(lock, [this] { return !_drawing; });
+            }
+
+            void PipelinedWindowlessGraphics::run_on_render_thread(const task_t& task)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _tasks.push_back(task);
+            }
+
+            void PipelinedWindowlessGraphics::look_at(const Eigen::Vector3d& camera_pos, const Eigen::Vector3d& look_at, const Eigen::Vector3d& up)
+            {
+                run_on_render_thread([=](WindowlessGLApplication& app) { app.look_at(camera_pos, look_at, up); });
+            }
+
+            void PipelinedWindowlessGraphics::clear_lights()
+            {
+                run_on_render_thread([](WindowlessGLApplication& app) { app.clear_lights(); });
+            }
+
+            void PipelinedWindowlessGraphics::add_light(const gs::Light& light)
+            {
+                run_on_render_thread([=](WindowlessGLApplication& app) { app.add_light(light); });
+            }
+
+            void PipelinedWindowlessGraphics::enable_shadows(bool enable, bool transparent)
+            {
+                run_on_render_thread([=](WindowlessGLApplication& app) { app.enable_shadows(enable, transparent); });
+            }
+
+            void PipelinedWindowlessGraphics::record_depth(bool recording_depth)
+            {
+                run_on_render_thread([=](WindowlessGLApplication& app) { app.camera().record(true, recording_depth); });
+            }
+
+            void PipelinedWindowlessGraphics::record_video(const std::string& video_fname, int fps)
+            {
+                int fps_computed = (fps == -1) ? _fps : fps;
+                ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(fps_computed != -1 && "Video FPS not set!");
+
+                run_on_render_thread([=](WindowlessGLApplication& app) { app.record_video(video_fname, fps_computed); });
+            }
+
+            Image PipelinedWindowlessGraphics::image()
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _image;
+            }
+
+            GrayscaleImage PipelinedWindowlessGraphics::depth_image()
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _depth_image;
+            }
+
+            GrayscaleImage PipelinedWindowlessGraphics::raw_depth_image()
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _raw_depth_image;
+            }
+
+            void PipelinedWindowlessGraphics::_render_loop(GraphicsConfiguration configuration)
+            {
+                Corrade::Utility::Debug magnum_silence_output{nullptr};
+                get_gl_context(gl_context);
+                robot_dart_initialize_magnum_resources();
+
+                std::unique_ptr<WindowlessGLApplication> app(static_cast<WindowlessGLApplication*>(make_application<WindowlessGLApplication>(_simu, configuration)));
+
+                std::unique_lock<std::mutex> lock(_mutex);
+                _ready = true;
+                _cv.notify_all();
+
+                std::vector<task_t> tasks;
+                while (true) {
+                    _cv.wait(lock, [this] { return _sync_requested || _stop; });
+                    if (_stop)
+                        break;
+
+                    // sync: the physics is waiting, the DART world can be read
+                    tasks.swap(_tasks);
+                    for (auto& task : tasks)
+                        task(*app);
+                    tasks.clear();
+                    app->update_graphics();
+
+                    _sync_requested = false;
+                    _synced = true;
+                    lock.unlock();
+                    _cv.notify_all();
+
+                    // draw and read back the frame while the physics continues
+                    app->draw_frame();
+
+                    Image image;
+                    GrayscaleImage depth_image, raw_depth_image;
+                    if (app->image())
+                        image = gs::rgb_from_image(&*app->image());
+                    if (app->camera().recording_depth()) {
+                        depth_image = app->depth_image();
+                        raw_depth_image = app->raw_depth_image();
+                    }
+                    _done = app->done();
+
+                    lock.lock();
+                    std::swap(_image, image);
+                    std::swap(_depth_image, depth_image);
+                    std::swap(_raw_depth_image, raw_depth_image);
+                    _frame_counter++;
+                    _drawing = false;
+                    _cv.notify_all();
+                }
+                lock.unlock();
+
+                app.reset();
+                release_gl_context(gl_context);
+            }
+        } // namespace magnum
+    } // namespace gui
+} // namespace robot_dart
@@ -0,0 +1,79 @@
+#ifndef ROBOT_DART_GUI_MAGNUM_PIPELINED_WINDOWLESS_GRAPHICS_HPP
+#define ROBOT_DART_GUI_MAGNUM_PIPELINED_WINDOWLESS_GRAPHICS_HPP
+
+#include <robot_dart/gui/magnum/windowless_gl_application.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace robot_dart {
+    namespace gui {
+        namespace magnum {
+            // Windowless graphics that render on their own thread (which owns the GL context).
+            // refresh() only blocks while the render thread copies the body transforms from the DART world
+            // into its scene graph; the frame is then drawn and read back while the physics continues.
+            // image()/depth_image() return the latest completed frame.
+            // Caveats: the application must only be accessed through run_on_render_thread(), and debug
+            // drawing (axes/ghosts) is disabled as it reads the DART world while drawing.
+            class PipelinedWindowlessGraphics : public Base {
+            public:
+                using task_t = std::function<void(WindowlessGLApplication&)>;
+
+                PipelinedWindowlessGraphics(RobotDARTSimu* simu, const GraphicsConfiguration& configuration = GraphicsConfiguration());
+                ~PipelinedWindowlessGraphics();
+
+                bool done() const override { return _done; }
+
+                void refresh() override;
+                void finish() override;
+
+                void set_enable(bool enable) override { _enabled = enable; }
+                void set_fps(int fps) override { _fps = fps; }
+
+                size_t frame_counter() const { return _frame_counter; }
+
+                // run a task on the render thread before the next frame (asynchronous)
+                void run_on_render_thread(const task_t& task);
+
+                void look_at(const Eigen::Vector3d& camera_pos,
+                    const Eigen::Vector3d& look_at = Eigen::Vector3d(0, 0, 0),
+                    const Eigen::Vector3d& up = Eigen::Vector3d(0, 0, 1));
+                void clear_lights();
+                void add_light(const gs::Light& light);
+                void enable_shadows(bool enable = true, bool transparent = true);
+                void record_depth(bool recording_depth = true);
+                void record_video(const std::string& video_fname, int fps = -1);
+
+                Image image() override;
+                GrayscaleImage depth_image() override;
+                GrayscaleImage raw_depth_image() override;
+
+            protected:
+                void _render_loop(GraphicsConfiguration configuration);
+
+                RobotDARTSimu* _simu;
+                int _fps = -1;
+                bool _enabled = true;
+                std::atomic<bool> _done{false};
+                std::atomic<size_t> _frame_counter{0};
+
+                std::thread _thread;
+                std::mutex _mutex;
+                std::condition_variable _cv;
+                // handshake with the render thread (protected by _mutex)
+                bool _ready = false, _stop = false;
+                bool _sync_requested = false, _synced = false, _drawing = false;
+                std::vector<task_t> _tasks;
+
+                // latest completed frame (protected by _mutex)
+                Image _image;
+                GrayscaleImage _depth_image, _raw_depth_image;
+            };
+        } // namespace magnum
+    } // namespace gui
+} // namespace robot_dart
+
+#endif
@@ -56,6 +56,13 @@ namespace robot_dart {
                 if (_draw_main_camera) {
                     /* Update graphic meshes/materials and render */
                     update_graphics();
+                    draw_frame();
+                }
+            }
+
+            void WindowlessGLApplication::draw_frame()
+            {
+                if (_draw_main_camera) {
                     /* Update lights transformations --- this also draws the shadows if enabled */
                     update_lights(*_camera);
 
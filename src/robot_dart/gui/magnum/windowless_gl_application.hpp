@@ -15,6 +15,8 @@ namespace robot_dart {
                 ~WindowlessGLApplication();
 
                 void render() override;
+                // render() without the update of the graphics from the DART world (see update_graphics())
+                void draw_frame();
 
             protected:
                 RobotDARTSimu* _simu;
@@ -17,14 +17,46 @@ namespace robot_dart {
                 bool is_ghost;
             };
 
+            // what was last written for each robot; used to skip robots whose GUI options did not change
+            struct RobotVersion {
+                size_t gui_version;
+                size_t num_shapes;
+                std::vector<dart::dynamics::ShapeNode*> shapes;
+            };
+
             std::unordered_map<dart::dynamics::ShapeNode*, RobotData> robot_data;
+            std::unordered_map<Robot*, RobotVersion> robot_versions;
             std::unordered_map<Robot*, std::vector<std::pair<dart::dynamics::BodyNode*, double>>> robot_axes;
+            std::vector<std::pair<dart::dynamics::BodyNode*, double>> all_axes;
+
+            void update_axes()
+            {
+                all_axes.clear();
+                for (auto& elem : robot_axes)
+                    all_axes.insert(all_axes.end(), elem.second.begin(), elem.second.end());
+            }
 
         public:
             void update_robot(const std::shared_ptr<Robot>& robot)
             {
                 auto robot_ptr = &*robot;
                 auto skel = robot->skeleton();
+                size_t num_shapes = skel->getNumShapeNodes();
+
+                auto version_iter = robot_versions.find(robot_ptr);
+                if (version_iter != robot_versions.end()) {
+                    // nothing changed since the last update
+                    if (version_iter->second.gui_version == robot->gui_version() && version_iter->second.num_shapes == num_shapes)
+                        return;
+                    for (auto shape : version_iter->second.shapes)
+                        robot_data.erase(shape);
+                }
+
+                auto& version = robot_versions[robot_ptr];
+                version.gui_version = robot->gui_version();
+                version.num_shapes = num_shapes;
+                version.shapes.clear();
+
                 bool cast = robot->cast_shadows();
                 bool ghost = robot->ghost();
 
@@ -33,35 +65,42 @@ namespace robot_dart {
                     auto& shapes = bd->getShapeNodesWith<dart::dynamics::VisualAspect>();
                     for (size_t j = 0; j < shapes.size(); j++) {
                         robot_data[shapes[j]] = {cast, ghost};
+                        version.shapes.push_back(shapes[j]);
                     }
                 }
 
                 auto& axes = robot->drawing_axes();
                 if (axes.size() > 0)
                     robot_axes[robot_ptr] = axes;
+                else
+                    robot_axes.erase(robot_ptr);
+                update_axes();
             }
 
             void remove_robot(const std::shared_ptr<Robot>& robot)
             {
                 auto robot_ptr = &*robot;
                 auto skel = robot->skeleton();
-                for (size_t i = 0; i < skel->getNumShapeNodes(); ++i) {
-                    auto shape = skel->getShapeNode(i);
-                    auto shape_iter = robot_data.find(shape);
-                    if (shape_iter != robot_data.end())
-                        robot_data.erase(shape_iter);
+                for (size_t i = 0; i < skel->getNumShapeNodes(); ++i)
+                    robot_data.erase(skel->getShapeNode(i));
+
+                auto version_iter = robot_versions.find(robot_ptr);
+                if (version_iter != robot_versions.end()) {
+                    // shapes that were removed from the skeleton since the last update
+                    for (auto shape : version_iter->second.shapes)
+                        robot_data.erase(shape);
+                    robot_versions.erase(version_iter);
                 }
 
-                auto iter = robot_axes.find(robot_ptr);
-                if (iter != robot_axes.end())
-                    robot_axes.erase(iter);
+                if (robot_axes.erase(robot_ptr) > 0)
+                    update_axes();
             }
 
             bool cast_shadows(dart::dynamics::ShapeNode* shape) const
             {
                 auto shape_iter = robot_data.find(shape);
                 if (shape_iter != robot_data.end())
-                    return robot_data.at(shape).casting_shadows;
+                    return shape_iter->second.casting_shadows;
                 // if not in the array, cast shadow by default
                 return true;
             }
@@ -70,19 +109,14 @@ namespace robot_dart {
             {
                 auto shape_iter = robot_data.find(shape);
                 if (shape_iter != robot_data.end())
-                    return robot_data.at(shape).is_ghost;
+                    return shape_iter->second.is_ghost;
                 // if not in the array, the robot is not ghost by default
                 return false;
             }
 
-            std::vector<std::pair<dart::dynamics::BodyNode*, double>> drawing_axes() const
+            const std::vector<std::pair<dart::dynamics::BodyNode*, double>>& drawing_axes() const
             {
-                std::vector<std::pair<dart::dynamics::BodyNode*, double>> axes;
-                for (std::pair<Robot*, std::vector<std::pair<dart::dynamics::BodyNode*, double>>> elem : robot_axes) {
-                    axes.insert(axes.end(), elem.second.begin(), elem.second.end());
-                }
-
-                return axes;
+                return all_axes;
             }
         };
     } // namespace simu
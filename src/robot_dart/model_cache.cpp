@@ -0,0 +1,172 @@
+#include "model_cache.hpp"
+#include "robot.hpp"
+#include "utils.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <tuple>
+
+namespace robot_dart {
+    namespace detail {
+        // cloneSkeleton() shares the shapes: the clone gets its own copies (e.g., the color mode of the meshes is per robot)
+        dart::dynamics::SkeletonPtr clone_with_shapes(const dart::dynamics::SkeletonPtr& skeleton)
+        {
+            auto tmp_skel = skeleton->cloneSkeleton();
+            for (size_t i = 0; i < tmp_skel->getNumShapeNodes(); i++) {
+                auto sn = tmp_skel->getShapeNode(i);
+                sn->setShape(sn->getShape()->clone());
+            }
+            return tmp_skel;
+        }
+    } // namespace detail
+
+    ModelCache& ModelCache::instance()
+    {
+        static ModelCache cache;
+        return cache;
+    }
+
+    void ModelCache::set_enabled(bool enable)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _enabled = enable;
+    }
+
+    bool ModelCache::enabled() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _enabled;
+    }
+
+    bool ModelCache::preload(const std::string& model_file, const packages_t& packages)
+    {
+        // the Robot constructor parses the file and fills the cache
+        try {
+            Robot robot(model_file, packages);
+        }
+        catch (Assertion&) {
+            return false;
+        }
+        return true;
+    }
+
+    void ModelCache::evict(const std::string& model_file)
+    {
+        std::string path = absolute_path(model_file);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto it = _entries.begin(); it != _entries.end();) {
+            if (it->first.path == path)
+                it = _entries.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void ModelCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.clear();
+    }
+
+    size_t ModelCache::size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _entries.size();
+    }
+
+    dart::dynamics::SkeletonPtr ModelCache::get(const std::string& model_file, const packages_t& packages, const std::string& robot_name)
+    {
+        long long mtime, size;
+        if (!_file_info(model_file, mtime, size))
+            return nullptr;
+
+        dart::dynamics::SkeletonPtr skeleton;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_enabled)
+                return nullptr;
+
+            auto it = _entries.find(_key(model_file, packages, robot_name));
+            if (it == _entries.end())
+                return nullptr;
+            if (it->second.mtime != mtime || it->second.size != size) {
+                _entries.erase(it);
+                return nullptr;
+            }
+            skeleton = it->second.skeleton;
+        }
+
+        // the clone attaches (and then detaches) new ShapeFrames to the shapes of the cached skeleton, and the signals
+        // of the shapes are not thread-safe: the clones of an entry are serialized by the mutex of its skeleton
+        // (the cache itself is not locked while cloning)
+        std::lock_guard<std::mutex> lock(skeleton->getMutex());
+        return detail::clone_with_shapes(skeleton);
+    }
+
+    void ModelCache::insert(const std::string& model_file, const packages_t& packages, const std::string& robot_name, const dart::dynamics::SkeletonPtr& skeleton)
+    {
+        Entry entry;
+        if (!skeleton || !_file_info(model_file, entry.mtime, entry.size))
+            return;
+
+        if (!enabled())
+            return;
+
+        // keep a copy (with its own shapes): the skeleton given to the robot will be modified
+        entry.skeleton = detail::clone_with_shapes(skeleton);
+        // update the kinematics once (like RobotPrototype): cloning only reads the cached skeleton afterwards
+        entry.skeleton->computeForwardKinematics();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_enabled)
+            _entries[_key(model_file, packages, robot_name)] = entry;
+    }
+
+    std::string ModelCache::absolute_path(const std::string& model_file)
+    {
+        // Remove spaces from beginning of the filename/path
+        std::string path = model_file;
+        path.erase(path.begin(), std::find_if(path.begin(), path.end(), [](int ch) {
+            return !std::isspace(ch);
+        }));
+
+        if (path[0] != '/') {
+            constexpr size_t max_size = 512;
+            char buff[max_size];
+            auto val = getcwd(buff, max_size);
+            if (!val)
+                return "";
+            path = std::string(buff) + "/" + path;
+        }
+
+        return path;
+    }
+
+    bool ModelCache::Key::operator<(const Key& other) const
+    {
+        return std::tie(path, packages, robot_name) < std::tie(other.path, other.packages, other.robot_name);
+    }
+
+    ModelCache::Key ModelCache::_key(const std::string& path, const packages_t& packages, const std::string& robot_name)
+    {
+        std::string extension = path.substr(path.find_last_of(".") + 1);
+        return {path, packages, extension == "skel" ? robot_name : ""};
+    }
+
+    bool ModelCache::_file_info(const std::string& path, long long& mtime, long long& size)
+    {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+            return false;
+#if defined(__APPLE__)
+        mtime = info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+        mtime = info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+        size = static_cast<long long>(info.st_size);
+        return true;
+    }
+} // namespace robot_dart
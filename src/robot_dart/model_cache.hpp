@@ -0,0 +1,67 @@
+#ifndef ROBOT_DART_MODEL_CACHE_HPP
+#define ROBOT_DART_MODEL_CACHE_HPP
+
+#include <dart/dynamics/Skeleton.hpp>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace robot_dart {
+    // Process-wide cache of the models parsed by the Robot constructors (URDF/SDF/SKEL files, not URDF strings).
+    // Entries are keyed by the absolute path of the file and the packages; they are parsed again when the
+    // modification time (or size) of the file changes. Every robot gets a clone of the cached skeleton with its own
+    // copies of the shapes (and meshes): unlike Robot::clone(), the robots loaded from the same file share nothing.
+    class ModelCache {
+    public:
+        using packages_t = std::vector<std::pair<std::string, std::string>>;
+
+        static ModelCache& instance();
+
+        // enabled by default
+        void set_enabled(bool enable);
+        bool enabled() const;
+
+        // parse a model now (e.g., before starting the workers); returns false if it cannot be loaded
+        bool preload(const std::string& model_file, const packages_t& packages = packages_t());
+        // remove all the entries of a file (all the packages)
+        void evict(const std::string& model_file);
+        void clear();
+        size_t size() const;
+
+        // used by Robot: a clone of the cached skeleton, nullptr if not cached (or outdated)
+        dart::dynamics::SkeletonPtr get(const std::string& model_file, const packages_t& packages, const std::string& robot_name);
+        void insert(const std::string& model_file, const packages_t& packages, const std::string& robot_name, const dart::dynamics::SkeletonPtr& skeleton);
+
+        // path of the model after removing the leading spaces, relative to the current directory if not absolute ("" on error)
+        static std::string absolute_path(const std::string& model_file);
+
+    protected:
+        ModelCache() = default;
+
+        struct Key {
+            std::string path;
+            packages_t packages;
+            // only for SKEL worlds (the robot is selected by name)
+            std::string robot_name;
+
+            bool operator<(const Key& other) const;
+        };
+
+        struct Entry {
+            long long mtime, size; // mtime in nanoseconds
+            dart::dynamics::SkeletonPtr skeleton;
+        };
+
+        static Key _key(const std::string& path, const packages_t& packages, const std::string& robot_name);
+        static bool _file_info(const std::string& path, long long& mtime, long long& size);
+
+        mutable std::mutex _mutex;
+        std::map<Key, Entry> _entries;
+        bool _enabled = true;
+    };
+} // namespace robot_dart
+
+#endif
@@ -0,0 +1,67 @@
+#include "population_evaluator.hpp"
+#include "utils.hpp"
+
+#include <robot_dart/control/robot_control.hpp>
+
+namespace robot_dart {
+    PopulationEvaluator::PopulationEvaluator(const simu_factory_t& factory, double duration, size_t num_threads, size_t robot_index, size_t controller_index) : _duration(duration), _pool(num_threads)
+    {
+        for (size_t i = 0; i < _pool.num_threads(); i++) {
+            auto simu = factory();
+            ROBOT_DART_EXCEPTION_ASSERT(simu, "PopulationEvaluator: the factory returned no simulation");
+            ROBOT_DART_EXCEPTION_ASSERT(robot_index < simu->num_robots(), "PopulationEvaluator: robot index out of bounds");
+            auto robot = simu->robot(robot_index);
+            ROBOT_DART_EXCEPTION_ASSERT(controller_index < robot->num_controllers(), "PopulationEvaluator: controller index out of bounds");
+
+            _simus.push_back(simu);
+            _controllers.push_back(robot->controller(controller_index));
+            _initial_states.push_back(simu->save_state());
+        }
+    }
+
+    size_t PopulationEvaluator::num_threads() const
+    {
+        return _pool.num_threads();
+    }
+
+    Eigen::MatrixXd PopulationEvaluator::evaluate(const Eigen::MatrixXd& params, const descriptor_t& descriptor)
+    {
+        std::vector<Eigen::VectorXd> outputs(params.rows());
+        _pool.parallel_for(params.rows(), [&](size_t i, size_t thread_id) {
+            _evaluate(thread_id, params.row(i).transpose());
+            outputs[i] = descriptor(*_simus[thread_id]);
+        });
+
+        if (outputs.empty())
+            return Eigen::MatrixXd();
+
+        Eigen::MatrixXd result(outputs.size(), outputs[0].size());
+        for (size_t i = 0; i < outputs.size(); i++) {
+            ROBOT_DART_EXCEPTION_ASSERT(outputs[i].size() == result.cols(), "PopulationEvaluator: the descriptor does not always have the same size");
+            result.row(i) = outputs[i].transpose();
+        }
+
+        return result;
+    }
+
+    Eigen::VectorXd PopulationEvaluator::evaluate_fitness(const Eigen::MatrixXd& params, const std::function<double(RobotDARTSimu& simu)>& fitness)
+    {
+        Eigen::VectorXd result(params.rows());
+        _pool.parallel_for(params.rows(), [&](size_t i, size_t thread_id) {
+            _evaluate(thread_id, params.row(i).transpose());
+            result(i) = fitness(*_simus[thread_id]);
+        });
+
+        return result;
+    }
+
+    void PopulationEvaluator::_evaluate(size_t thread_id, const Eigen::VectorXd& params)
+    {
+        auto& simu = _simus[thread_id];
+
+        _controllers[thread_id]->set_parameters(params);
+        // after set_parameters: the state of the controller is restored as well
+        simu->restore_state(_initial_states[thread_id]);
+        simu->run(_duration);
+    }
+} // namespace robot_dart
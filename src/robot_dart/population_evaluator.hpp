@@ -0,0 +1,48 @@
+#ifndef ROBOT_DART_POPULATION_EVALUATOR_HPP
+#define ROBOT_DART_POPULATION_EVALUATOR_HPP
+
+#include <robot_dart/robot_dart_simu.hpp>
+#include <robot_dart/thread_pool.hpp>
+
+#include <functional>
+
+namespace robot_dart {
+    // Evaluates populations of controller parameters on simulations that are built once per worker thread.
+    // Every individual is evaluated by pushing its parameters to the controller (RobotControl::set_parameters),
+    // restoring the initial state of the simulation (see RobotDARTSimu::save_state) and running it for a fixed duration.
+    // The simulations are meant to be headless and must be fully deterministic from their saved state.
+    class PopulationEvaluator {
+    public:
+        using simu_t = std::shared_ptr<RobotDARTSimu>;
+        // builds a simulation with its robots and controllers (called once per worker, never concurrently)
+        using simu_factory_t = std::function<simu_t()>;
+        // output of an individual, computed at the end of its evaluation
+        using descriptor_t = std::function<Eigen::VectorXd(RobotDARTSimu& simu)>;
+
+        // num_threads == 0 uses all the available hardware threads
+        PopulationEvaluator(const simu_factory_t& factory, double duration, size_t num_threads = 0, size_t robot_index = 0, size_t controller_index = 0);
+
+        size_t num_threads() const;
+        double duration() const { return _duration; }
+        void set_duration(double duration) { _duration = duration; }
+
+        // one simulation per worker thread
+        const std::vector<simu_t>& simus() const { return _simus; }
+
+        // one individual per row of params, one output per row of the result
+        Eigen::MatrixXd evaluate(const Eigen::MatrixXd& params, const descriptor_t& descriptor);
+        // same with a single output value per individual (e.g., fitness)
+        Eigen::VectorXd evaluate_fitness(const Eigen::MatrixXd& params, const std::function<double(RobotDARTSimu& simu)>& fitness);
+
+    protected:
+        void _evaluate(size_t thread_id, const Eigen::VectorXd& params);
+
+        std::vector<simu_t> _simus;
+        std::vector<SimuState> _initial_states;
+        std::vector<std::shared_ptr<control::RobotControl>> _controllers;
+        double _duration;
+        ThreadPool _pool;
+    };
+} // namespace robot_dart
+
+#endif
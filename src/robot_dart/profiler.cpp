@@ -0,0 +1,114 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace robot_dart {
+    namespace detail {
+        constexpr double profiler_first_bucket = 0.1; // us
+        constexpr double profiler_buckets_per_octave = 4.;
+    } // namespace detail
+
+    constexpr size_t StepProfiler::_num_buckets;
+
+    bool StepProfiler::enabled()
+    {
+#ifdef ROBOT_DART_ENABLE_PROFILING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::string StepProfiler::phase_name(Phase phase)
+    {
+        switch (phase) {
+        case ROBOT_UPDATE:
+            return "robot_update";
+        case WORLD_STEP:
+            return "world_step";
+        case DESCRIPTORS:
+            return "descriptors";
+        case CAMERAS:
+            return "cameras";
+        case GRAPHICS:
+            return "graphics";
+        case GUI_DATA:
+            return "gui_data";
+        case GRAPHICS_WAIT:
+            return "graphics_wait";
+        default:
+            return "unknown";
+        }
+    }
+
+    void StepProfiler::add_sample(Phase phase, double microseconds)
+    {
+        auto& hist = _histograms[phase];
+        hist.count++;
+        hist.sum += microseconds;
+        hist.min = std::min(hist.min, microseconds);
+        hist.max = std::max(hist.max, microseconds);
+
+        int bucket = 0;
+        if (microseconds > detail::profiler_first_bucket)
+            bucket = static_cast<int>(detail::profiler_buckets_per_octave * std::log2(microseconds / detail::profiler_first_bucket));
+        bucket = std::max(0, std::min(bucket, static_cast<int>(_num_buckets) - 1));
+        hist.buckets[bucket]++;
+    }
+
+    StepProfiler::Stats StepProfiler::stats(Phase phase) const
+    {
+        Stats st;
+        const auto& hist = _histograms[phase];
+        if (hist.count == 0)
+            return st;
+
+        st.count = hist.count;
+        st.min = hist.min;
+        st.max = hist.max;
+        st.total = hist.sum;
+        st.mean = hist.sum / hist.count;
+
+        // upper edge of the bucket that contains the 99th percentile
+        size_t rank = static_cast<size_t>(std::ceil(0.99 * hist.count));
+        size_t accum = 0;
+        for (size_t i = 0; i < _num_buckets; i++) {
+            accum += hist.buckets[i];
+            if (accum >= rank) {
+                st.p99 = detail::profiler_first_bucket * std::pow(2., (i + 1) / detail::profiler_buckets_per_octave);
+                break;
+            }
+        }
+        st.p99 = std::max(st.min, std::min(st.p99, st.max));
+
+        return st;
+    }
+
+    void StepProfiler::reset()
+    {
+        for (auto& hist : _histograms) {
+            hist.count = 0;
+            hist.min = std::numeric_limits<double>::max();
+            hist.max = 0.;
+            hist.sum = 0.;
+            hist.buckets.fill(0);
+        }
+    }
+
+    std::string StepProfiler::summary() const
+    {
+        std::ostringstream str;
+        str << std::left << std::setw(14) << "phase" << std::right << std::setw(10) << "calls" << std::setw(12) << "min(us)" << std::setw(12) << "mean(us)" << std::setw(12) << "p99(us)" << std::setw(12) << "max(us)" << std::setw(14) << "total(ms)" << std::endl;
+        str << std::fixed << std::setprecision(2);
+        for (int i = 0; i < NUM_PHASES; i++) {
+            auto st = stats(static_cast<Phase>(i));
+            str << std::left << std::setw(14) << phase_name(static_cast<Phase>(i)) << std::right << std::setw(10) << st.count << std::setw(12) << st.min << std::setw(12) << st.mean << std::setw(12) << st.p99 << std::setw(12) << st.max << std::setw(14) << st.total * 1e-3 << std::endl;
+        }
+
+        return str.str();
+    }
+} // namespace robot_dart
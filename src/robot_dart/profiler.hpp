@@ -0,0 +1,82 @@
+#ifndef ROBOT_DART_PROFILER_HPP
+#define ROBOT_DART_PROFILER_HPP
+
+#include <array>
+#include <chrono>
+#include <string>
+
+namespace robot_dart {
+    // Wall-clock statistics of the phases of RobotDARTSimu::step()/step_world().
+    // Samples are only recorded when the library is compiled with ROBOT_DART_ENABLE_PROFILING
+    // (./waf configure --profiling); otherwise the instrumentation compiles to nothing.
+    class StepProfiler {
+    public:
+        enum Phase {
+            ROBOT_UPDATE = 0, // Robot::update() of all the robots (controllers)
+            WORLD_STEP, // dart::simulation::World::step()
+            DESCRIPTORS, // descriptor callbacks
+            CAMERAS, // refresh() of the cameras (sensors)
+            GRAPHICS, // refresh() of the graphics
+            GUI_DATA, // GUIData::update_robot() of all the robots
+            GRAPHICS_WAIT, // finish() of the graphics (waiting for the previous frame of a pipelined renderer)
+            NUM_PHASES
+        };
+
+        // all times are in microseconds
+        struct Stats {
+            size_t count = 0;
+            double min = 0., mean = 0., max = 0., p99 = 0., total = 0.;
+        };
+
+        StepProfiler() { reset(); }
+
+        // true if the library was compiled with the instrumentation
+        static bool enabled();
+        static std::string phase_name(Phase phase);
+
+        void add_sample(Phase phase, double microseconds);
+        Stats stats(Phase phase) const;
+
+        void reset();
+
+        // human-readable table of all the phases
+        std::string summary() const;
+
+    protected:
+        // logarithmic histogram: 4 buckets per octave starting at 0.1us (the last bucket is at ~1.6s)
+        static constexpr size_t _num_buckets = 96;
+
+        struct Histogram {
+            size_t count;
+            double min, max, sum;
+            std::array<size_t, _num_buckets> buckets;
+        };
+
+        std::array<Histogram, NUM_PHASES> _histograms;
+    };
+
+    class ScopedPhaseTimer {
+    public:
+        using clock_t = std::chrono::steady_clock;
+
+        ScopedPhaseTimer(StepProfiler& profiler, StepProfiler::Phase phase) : _profiler(profiler), _phase(phase), _start(clock_t::now()) {}
+        ~ScopedPhaseTimer()
+        {
+            std::chrono::duration<double, std::micro> elapsed = clock_t::now() - _start;
+            _profiler.add_sample(_phase, elapsed.count());
+        }
+
+    protected:
+        StepProfiler& _profiler;
+        StepProfiler::Phase _phase;
+        clock_t::time_point _start;
+    };
+} // namespace robot_dart
+
+#ifdef ROBOT_DART_ENABLE_PROFILING
+#define ROBOT_DART_PROFILE_PHASE(profiler, phase) robot_dart::ScopedPhaseTimer robot_dart_scoped_phase_timer(profiler, robot_dart::StepProfiler::phase)
+#else
+#define ROBOT_DART_PROFILE_PHASE(profiler, phase)
+#endif
+
+#endif
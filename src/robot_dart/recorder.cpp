@@ -0,0 +1,251 @@
+#include "recorder.hpp"
+#include "utils.hpp"
+
+#include <cstring>
+
+namespace robot_dart {
+    namespace detail {
+        constexpr char log_magic[8] = {'R', 'D', 'A', 'R', 'T', 'L', 'O', 'G'};
+        constexpr uint32_t log_version = 1;
+
+        template <typename T>
+        void write(std::ofstream& file, const T& value)
+        {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        bool read(std::ifstream& file, T& value)
+        {
+            return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+    } // namespace detail
+
+    Recorder::Recorder(const std::string& filename, size_t keyframe_period) : _filename(filename), _file(filename, std::ios::binary | std::ios::trunc), _keyframe_period(keyframe_period)
+    {
+        ROBOT_DART_EXCEPTION_ASSERT(_file.is_open(), "Recorder: cannot open " + filename);
+    }
+
+    Recorder::~Recorder()
+    {
+        close();
+    }
+
+    void Recorder::flush()
+    {
+        _file.flush();
+    }
+
+    void Recorder::close()
+    {
+        if (_closed)
+            return;
+        if (_header_written) {
+            detail::write(_file, 'E');
+            detail::write(_file, _end_tick);
+        }
+        _file.close();
+        _closed = true;
+    }
+
+    void Recorder::record_state(const RobotDARTSimu& simu)
+    {
+        if (_closed)
+            return;
+        if (!_header_written)
+            _write_header(simu);
+
+        // always start with a keyframe so that the log can be replayed on its own
+        if (_num_ticks > 0 && (_keyframe_period == 0 || _num_ticks % _keyframe_period != 0))
+            return;
+
+        simu.save_state(_state);
+        detail::write(_file, 'K');
+        detail::write(_file, static_cast<int64_t>(simu.scheduler().current_step()));
+        detail::write(_file, static_cast<uint64_t>(_state.layout.size()));
+        for (size_t v : _state.layout)
+            detail::write(_file, static_cast<uint64_t>(v));
+        detail::write(_file, static_cast<uint64_t>(_state.data.size()));
+        _file.write(reinterpret_cast<const char*>(_state.data.data()), _state.data.size() * sizeof(double));
+    }
+
+    void Recorder::record_commands(const RobotDARTSimu& simu)
+    {
+        if (_closed)
+            return;
+        if (!_header_written)
+            _write_header(simu);
+
+        const auto& robots = simu.robots();
+        ROBOT_DART_ASSERT(robots.size() == _dofs.size(), "Recorder: the robots of the simulation changed while recording", );
+        for (size_t r = 0; r < robots.size(); r++)
+            ROBOT_DART_ASSERT(robots[r]->num_dofs() == _dofs[r], "Recorder: robot " + robots[r]->name() + " changed while recording", );
+
+        detail::write(_file, 'C');
+        detail::write(_file, static_cast<int64_t>(simu.scheduler().current_step()));
+        for (auto& robot : robots) {
+            Eigen::VectorXd commands = robot->skeleton()->getCommands();
+            _file.write(reinterpret_cast<const char*>(commands.data()), commands.size() * sizeof(double));
+        }
+
+        _num_ticks++;
+    }
+
+    void Recorder::record_step(const RobotDARTSimu& simu)
+    {
+        _end_tick = simu.scheduler().current_step();
+    }
+
+    void Recorder::_write_header(const RobotDARTSimu& simu)
+    {
+        _file.write(detail::log_magic, sizeof(detail::log_magic));
+        detail::write(_file, detail::log_version);
+        detail::write(_file, simu.timestep());
+        detail::write(_file, static_cast<int32_t>(simu.control_freq()));
+
+        const auto& robots = simu.robots();
+        detail::write(_file, static_cast<uint32_t>(robots.size()));
+        _dofs.clear();
+        for (auto& robot : robots) {
+            _dofs.push_back(robot->num_dofs());
+            detail::write(_file, static_cast<uint32_t>(robot->num_dofs()));
+            detail::write(_file, static_cast<uint32_t>(robot->name().size()));
+            _file.write(robot->name().data(), robot->name().size());
+        }
+
+        _header_written = true;
+    }
+
+    Replayer::Replayer(const std::string& filename) : _filename(filename), _file(filename, std::ios::binary)
+    {
+        ROBOT_DART_EXCEPTION_ASSERT(_file.is_open(), "Replayer: cannot open " + filename);
+
+        char magic[sizeof(detail::log_magic)];
+        uint32_t version = 0;
+        _file.read(magic, sizeof(magic));
+        ROBOT_DART_EXCEPTION_ASSERT(_file && std::memcmp(magic, detail::log_magic, sizeof(magic)) == 0, "Replayer: " + filename + " is not a robot_dart log");
+        ROBOT_DART_EXCEPTION_ASSERT(detail::read(_file, version) && version == detail::log_version, "Replayer: unsupported log version in " + filename);
+
+        int32_t control_freq;
+        uint32_t num_robots;
+        ROBOT_DART_EXCEPTION_ASSERT(detail::read(_file, _timestep) && detail::read(_file, control_freq) && detail::read(_file, num_robots), "Replayer: truncated header in " + filename);
+        _control_freq = control_freq;
+
+        size_t total_dofs = 0;
+        for (uint32_t r = 0; r < num_robots; r++) {
+            uint32_t dofs, name_size;
+            ROBOT_DART_EXCEPTION_ASSERT(detail::read(_file, dofs) && detail::read(_file, name_size), "Replayer: truncated header in " + filename);
+            std::string name(name_size, ' ');
+            _file.read(&name[0], name_size);
+            ROBOT_DART_EXCEPTION_ASSERT(_file, "Replayer: truncated header in " + filename);
+
+            _dofs.push_back(dofs);
+            _names.push_back(name);
+            total_dofs += dofs;
+        }
+        _commands.resize(total_dofs);
+
+        _read_next();
+    }
+
+    bool Replayer::step(RobotDARTSimu& simu, bool reset_commands)
+    {
+        if (_done)
+            return true;
+
+        if (!_checked) {
+            if (!_check(simu)) {
+                _done = true;
+                return true;
+            }
+            _checked = true;
+
+            // the first keyframe brings the simulation to the recorded tick
+            if (_next_type == 'K' && !_apply_next(simu))
+                return true;
+        }
+
+        int64_t tick = simu.scheduler().current_step();
+        while ((_next_type == 'K' || _next_type == 'C') && _next_tick == tick) {
+            if (!_apply_next(simu))
+                return true;
+        }
+
+        // without an end record (e.g., the recording process crashed), stop right after the last record
+        if ((_next_type == 'E' && tick >= _next_tick) || (_next_type == 0 && tick > _last_tick)) {
+            _done = true;
+            return true;
+        }
+
+        if (_next_type != 'E' && _next_type != 0 && _next_tick < tick) {
+            ROBOT_DART_WARNING(true, "Replayer: the simulation is ahead of the log (tick " << tick << ", next record at " << _next_tick << ")");
+            _done = true;
+            return true;
+        }
+
+        return simu.step_world(reset_commands);
+    }
+
+    void Replayer::run(RobotDARTSimu& simu, bool reset_commands)
+    {
+        while (!step(simu, reset_commands) && !simu.graphics()->done()) {
+        }
+    }
+
+    bool Replayer::_check(const RobotDARTSimu& simu) const
+    {
+        const auto& robots = simu.robots();
+        ROBOT_DART_ASSERT(robots.size() == _dofs.size(), "Replayer: the simulation does not have the same number of robots as the log", false);
+        for (size_t r = 0; r < robots.size(); r++)
+            ROBOT_DART_ASSERT(robots[r]->num_dofs() == _dofs[r], "Replayer: robot " + robots[r]->name() + " does not match " + _names[r] + " in the log", false);
+        ROBOT_DART_ASSERT(simu.timestep() == _timestep, "Replayer: the time step of the simulation is not the same as in the log", false);
+        return true;
+    }
+
+    void Replayer::_read_next()
+    {
+        if (!detail::read(_file, _next_type) || !detail::read(_file, _next_tick))
+            _next_type = 0;
+    }
+
+    bool Replayer::_apply_next(RobotDARTSimu& simu)
+    {
+        bool ok = true, restored = true;
+        if (_next_type == 'K') {
+            uint64_t size = 0, value = 0;
+            ok = detail::read(_file, size);
+            _state.layout.resize(ok ? size : 0);
+            for (size_t i = 0; ok && i < _state.layout.size(); i++) {
+                ok = detail::read(_file, value);
+                _state.layout[i] = value;
+            }
+            ok = ok && detail::read(_file, size);
+            if (ok) {
+                _state.data.resize(size);
+                ok = static_cast<bool>(_file.read(reinterpret_cast<char*>(_state.data.data()), size * sizeof(double)));
+            }
+            // the controllers are not run: only the robots are restored
+            if (ok)
+                restored = simu.restore_state(_state, false);
+        }
+        else if (_next_type == 'C') {
+            ok = static_cast<bool>(_file.read(reinterpret_cast<char*>(_commands.data()), _commands.size() * sizeof(double)));
+            size_t offset = 0;
+            for (size_t r = 0; ok && r < _dofs.size(); r++) {
+                simu.robot(r)->skeleton()->setCommands(_commands.segment(offset, _dofs[r]));
+                offset += _dofs[r];
+            }
+        }
+        _last_tick = _next_tick;
+
+        if (!ok || !restored) {
+            ROBOT_DART_WARNING(!ok, "Replayer: truncated record in " + _filename);
+            ROBOT_DART_WARNING(!restored, "Replayer: the keyframe at tick " << _last_tick << " does not match the simulation");
+            _done = true;
+            return false;
+        }
+
+        _read_next();
+        return true;
+    }
+} // namespace robot_dart
@@ -0,0 +1,98 @@
+#ifndef ROBOT_DART_RECORDER_HPP
+#define ROBOT_DART_RECORDER_HPP
+
+#include <robot_dart/robot_dart_simu.hpp>
+
+#include <cstdint>
+#include <fstream>
+
+namespace robot_dart {
+    // Binary log (native endianness) written by Recorder and read by Replayer:
+    //  header: "RDARTLOG", uint32 version, double timestep, int32 control frequency,
+    //          uint32 number of robots, then for each robot: uint32 number of DoFs, uint32 name length, name
+    //  records: 'K' int64 tick, uint64 layout size, layout (uint64), uint64 data size, data (double) -- SimuState keyframe
+    //           'C' int64 tick, commands of all the robots (double) -- one per control tick
+    //           'E' int64 tick -- end of the recording
+    // A tick is the step counter of the scheduler of the simulation.
+
+    // Streams the commands computed by the controllers at every control tick (and periodic keyframes) to a file.
+    // Attach it with RobotDARTSimu::set_recorder(); the robots must not change while recording.
+    class Recorder {
+    public:
+        // keyframe_period: write a keyframe every keyframe_period control ticks (0: only at the first tick)
+        Recorder(const std::string& filename, size_t keyframe_period = 0);
+        ~Recorder();
+
+        const std::string& filename() const { return _filename; }
+        size_t keyframe_period() const { return _keyframe_period; }
+        size_t num_ticks() const { return _num_ticks; }
+
+        void flush();
+        // writes the end record; nothing is recorded afterwards
+        void close();
+        bool closed() const { return _closed; }
+
+        // called by RobotDARTSimu::step() on every control tick, before and after updating the robots
+        void record_state(const RobotDARTSimu& simu);
+        void record_commands(const RobotDARTSimu& simu);
+        // called by RobotDARTSimu::step() after every step (no I/O, keeps the tick of the end record)
+        void record_step(const RobotDARTSimu& simu);
+
+    protected:
+        void _write_header(const RobotDARTSimu& simu);
+
+        std::string _filename;
+        std::ofstream _file;
+        size_t _keyframe_period;
+        size_t _num_ticks = 0;
+        int64_t _end_tick = 0;
+        bool _header_written = false;
+        bool _closed = false;
+        std::vector<size_t> _dofs;
+        SimuState _state;
+    };
+
+    // Drives RobotDARTSimu::step_world() from a log written by Recorder: the logged commands are applied at
+    // the recorded ticks and the controllers are not run (the state of the controllers in the keyframes is skipped).
+    // The simulation must contain the same robots; the first keyframe brings it to the recorded state.
+    // The replay stops if a keyframe cannot be restored.
+    class Replayer {
+    public:
+        Replayer(const std::string& filename);
+
+        const std::string& filename() const { return _filename; }
+        double timestep() const { return _timestep; }
+        int control_freq() const { return _control_freq; }
+        const std::vector<std::string>& robot_names() const { return _names; }
+
+        // replays one step; returns true when the log is over (or the simulation was stopped)
+        bool step(RobotDARTSimu& simu, bool reset_commands = false);
+        // replays the whole (remaining) log
+        void run(RobotDARTSimu& simu, bool reset_commands = false);
+
+        bool done() const { return _done; }
+
+    protected:
+        bool _check(const RobotDARTSimu& simu) const;
+        void _read_next();
+        bool _apply_next(RobotDARTSimu& simu);
+
+        std::string _filename;
+        std::ifstream _file;
+        double _timestep;
+        int _control_freq;
+        std::vector<size_t> _dofs;
+        std::vector<std::string> _names;
+
+        bool _checked = false;
+        bool _done = false;
+        char _next_type = 0;
+        int64_t _next_tick = 0;
+        int64_t _last_tick = -1;
+
+        SimuState _state;
+        Eigen::VectorXd _commands;
+    };
+} // namespace robot_dart
+
+#endif
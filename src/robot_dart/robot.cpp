@@ -1,10 +1,11 @@
 #include "robot.hpp"
+#include "collision_shape_cache.hpp"
+#include "model_cache.hpp"
 #include "utils.hpp"
 
-#include <unistd.h>
-
 #include <dart/config.hpp>
 #include <dart/dynamics/BoxShape.hpp>
+#include <dart/dynamics/CapsuleShape.hpp>
 #include <dart/dynamics/DegreeOfFreedom.hpp>
 #include <dart/dynamics/EllipsoidShape.hpp>
 #include <dart/dynamics/FreeJoint.hpp>
@@ -28,6 +29,8 @@ namespace dart {
 
 #include <robot_dart/control/robot_control.hpp>
 
+#include <atomic>
+
 namespace robot_dart {
     namespace detail {
         template <int content>
@@ -146,6 +149,73 @@ namespace robot_dart {
                     ROBOT_DART_EXCEPTION_ASSERT(false, "Unknown type of data!");
             }
         }
+
+        template <int content>
+        Eigen::VectorXd dof_data(dart::dynamics::SkeletonPtr skeleton, const std::vector<size_t>& indices)
+        {
+            if (content == 0)
+                return skeleton->getPositions(indices);
+            else if (content == 1)
+                return skeleton->getVelocities(indices);
+            else if (content == 2)
+                return skeleton->getAccelerations(indices);
+            else if (content == 3)
+                return skeleton->getForces(indices);
+            else if (content == 4)
+                return skeleton->getCommands(indices);
+            ROBOT_DART_EXCEPTION_ASSERT(false, "Unknown type of data!");
+        }
+
+        template <int content>
+        void set_dof_data(const Eigen::VectorXd& data, dart::dynamics::SkeletonPtr skeleton, const std::vector<size_t>& indices)
+        {
+            ROBOT_DART_ASSERT(static_cast<size_t>(data.size()) == indices.size(), "set_dof_data: size of data is not the same as the size of the DoF view", );
+            if (content == 0)
+                return skeleton->setPositions(indices, data);
+            else if (content == 1)
+                return skeleton->setVelocities(indices, data);
+            else if (content == 2)
+                return skeleton->setAccelerations(indices, data);
+            else if (content == 3)
+                return skeleton->setForces(indices, data);
+            else if (content == 4)
+                return skeleton->setCommands(indices, data);
+            ROBOT_DART_EXCEPTION_ASSERT(false, "Unknown type of data!");
+        }
+
+        template <int content>
+        double dof_value(const dart::dynamics::DegreeOfFreedom* dof)
+        {
+            if (content == 0)
+                return dof->getPosition();
+            else if (content == 1)
+                return dof->getVelocity();
+            else if (content == 2)
+                return dof->getAcceleration();
+            else if (content == 3)
+                return dof->getForce();
+            else if (content == 4)
+                return dof->getCommand();
+            ROBOT_DART_EXCEPTION_ASSERT(false, "Unknown type of data!");
+        }
+
+        // indices == nullptr: all the DoFs
+        template <int content>
+        void dof_data_into(Eigen::Ref<Eigen::VectorXd> out, const dart::dynamics::SkeletonPtr& skeleton, const std::vector<size_t>* indices)
+        {
+            size_t size = indices ? indices->size() : skeleton->getNumDofs();
+            ROBOT_DART_ASSERT(static_cast<size_t>(out.size()) == size, "dof_data_into: size of the buffer is not the same as the number of DoFs", );
+            for (size_t i = 0; i < size; i++)
+                out(i) = dof_value<content>(skeleton->getDof(indices ? (*indices)[i] : i));
+        }
+
+        // versions of the DoF maps and names: unique among all the robots, so that a cache (e.g., a view in a cloned
+        // controller) never mistakes a robot for another one (skeletons can be allocated at the address of a freed one)
+        size_t next_version()
+        {
+            static std::atomic<size_t> version(0);
+            return ++version;
+        }
     } // namespace detail
 
     Robot::Robot(const std::string& model_file, const std::vector<std::pair<std::string, std::string>>& packages, const std::string& robot_name, bool is_urdf_string, bool cast_shadows, std::vector<RobotDamage> damages) : _robot_name(robot_name), _skeleton(_load_model(model_file, packages, is_urdf_string)), _cast_shadows(cast_shadows), _is_ghost(false)
@@ -234,6 +304,100 @@ namespace robot_dart {
         return _damages;
     }
 
+    size_t Robot::simplify_collision_shapes(const std::string& type, const std::vector<std::string>& body_names)
+    {
+        ROBOT_DART_EXCEPTION_ASSERT(type == "convex_hull" || type == "box" || type == "capsule", "simplify_collision_shapes: unknown type '" + type + "' (convex_hull, box or capsule)");
+
+        size_t replaced = 0;
+        for (size_t i = 0; i < _skeleton->getNumBodyNodes(); ++i) {
+            auto bd = _skeleton->getBodyNode(i);
+            if (!body_names.empty() && std::find(body_names.begin(), body_names.end(), bd->getName()) == body_names.end())
+                continue;
+
+            // copy: new ShapeNodes are added to the body in the loop
+            std::vector<dart::dynamics::ShapeNode*> collision_shapes = bd->getShapeNodesWith<dart::dynamics::CollisionAspect>();
+            for (auto sn : collision_shapes) {
+                auto mesh = std::dynamic_pointer_cast<dart::dynamics::MeshShape>(sn->getShape());
+                if (!mesh || !mesh->getMesh())
+                    continue;
+
+                dart::dynamics::ShapePtr shape;
+                // pose of the new shape in the frame of the mesh
+                Eigen::Isometry3d offset = Eigen::Isometry3d::Identity();
+                if (type == "convex_hull")
+                    shape = CollisionShapeCache::instance().convex_hull(mesh);
+                else {
+                    auto vertices = CollisionShapeCache::mesh_vertices(mesh->getMesh());
+                    if (vertices.empty())
+                        continue;
+                    Eigen::Vector3d min = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+                    Eigen::Vector3d max = -min;
+                    for (auto& v : vertices) {
+                        v = v.cwiseProduct(mesh->getScale());
+                        min = min.cwiseMin(v);
+                        max = max.cwiseMax(v);
+                    }
+                    Eigen::Vector3d center = (min + max) / 2.;
+                    Eigen::Vector3d size = max - min;
+
+                    if (type == "box") {
+                        offset.translation() = center;
+                        shape = std::make_shared<dart::dynamics::BoxShape>(size);
+                    }
+                    else {
+                        // along the longest side of the bounding box: the radius covers all the vertices around the axis,
+                        // and the two spheres are moved as close as possible to each other while still covering the vertices
+                        int axis;
+                        size.maxCoeff(&axis);
+                        double radius = 0.;
+                        for (auto& v : vertices) {
+                            Eigen::Vector3d d = v - center;
+                            d[axis] = 0.;
+                            radius = std::max(radius, d.norm());
+                        }
+                        double bottom = std::numeric_limits<double>::max(), top = -bottom;
+                        for (auto& v : vertices) {
+                            Eigen::Vector3d d = v - center;
+                            double t = d[axis];
+                            d[axis] = 0.;
+                            double h = std::sqrt(std::max(0., radius * radius - d.squaredNorm()));
+                            bottom = std::min(bottom, t + h);
+                            top = std::max(top, t - h);
+                        }
+                        if (bottom > top)
+                            bottom = top = (bottom + top) / 2.;
+
+                        offset.translation() = center;
+                        offset.translation()[axis] += (bottom + top) / 2.;
+                        // the capsules of DART are along their Z axis
+                        if (axis == 0)
+                            offset.linear() = Eigen::AngleAxisd(M_PI / 2., Eigen::Vector3d::UnitY()).toRotationMatrix();
+                        else if (axis == 1)
+                            offset.linear() = Eigen::AngleAxisd(-M_PI / 2., Eigen::Vector3d::UnitX()).toRotationMatrix();
+                        shape = std::make_shared<dart::dynamics::CapsuleShape>(radius, top - bottom);
+                    }
+                }
+
+                if (!shape) {
+                    ROBOT_DART_WARNING(true, "simplify_collision_shapes: keeping the collision mesh of " + sn->getName());
+                    continue;
+                }
+
+                auto node = bd->createShapeNodeWith<dart::dynamics::CollisionAspect, dart::dynamics::DynamicsAspect>(shape, sn->getName() + "_" + type);
+                node->setRelativeTransform(sn->getRelativeTransform() * offset);
+                if (sn->getDynamicsAspect())
+                    node->getDynamicsAspect()->setAspectProperties(sn->getDynamicsAspect()->getAspectProperties());
+
+                // the original ShapeNode only keeps its visual aspect (if any)
+                sn->removeAspect<dart::dynamics::CollisionAspect>();
+                sn->removeAspect<dart::dynamics::DynamicsAspect>();
+                ++replaced;
+            }
+        }
+
+        return replaced;
+    }
+
     const std::string& Robot::name() const
     {
         return _robot_name;
@@ -241,12 +405,25 @@ namespace robot_dart {
 
     void Robot::update(double t)
     {
-        _skeleton->setCommands(Eigen::VectorXd::Zero(_skeleton->getNumDofs()));
+        // no allocation once the buffers have the right size (if the controllers implement calculate_into)
+        _commands.setZero(_skeleton->getNumDofs());
 
         for (auto& ctrl : _controllers) {
-            if (ctrl->active())
-                detail::add_dof_data<4>(ctrl->weight() * ctrl->calculate(t), _skeleton, ctrl->controllable_dofs(), _dof_map);
+            if (!ctrl->active())
+                continue;
+            const auto& indices = dof_indices(ctrl->controllable_dof_view());
+            ctrl->calculate_into(t, _controller_commands);
+            if (static_cast<size_t>(_controller_commands.size()) != indices.size()) {
+                ROBOT_DART_WARNING(true, "Robot::update: size of the commands of a controller is not the same as its controllable DoFs");
+                continue;
+            }
+
+            double weight = ctrl->weight();
+            for (size_t i = 0; i < indices.size(); i++)
+                _commands(indices[i]) += weight * _controller_commands(i);
         }
+
+        _skeleton->setCommands(_commands);
     }
 
     void Robot::reinit_controllers()
@@ -323,8 +500,8 @@ namespace robot_dart {
         _skeleton->getRootBodyNode()->changeParentJointType<dart::dynamics::WeldJoint>(properties);
         _skeleton->getRootBodyNode()->getParentJoint()->setTransformFromParentBodyNode(tf);
 
-        reinit_controllers();
         update_joint_dof_maps();
+        reinit_controllers();
     }
 
     // pose: Orientation-Position
@@ -347,8 +524,8 @@ namespace robot_dart {
         _skeleton->getRootBodyNode()->changeParentJointType<dart::dynamics::FreeJoint>(properties);
         _skeleton->getRootBodyNode()->getParentJoint()->setTransformFromParentBodyNode(tf);
 
-        reinit_controllers();
         update_joint_dof_maps();
+        reinit_controllers();
     }
 
     bool Robot::fixed() const
@@ -432,6 +609,7 @@ namespace robot_dart {
 
         jnt->setActuatorType(dart::dynamics::Joint::MIMIC);
         jnt->setMimicJoint(mimic_jnt, multiplier, offset);
+        _update_dof_names();
     }
 
     std::string Robot::actuator_type(const std::string& joint_name) const
@@ -718,6 +896,118 @@ namespace robot_dart {
         detail::set_dof_data<4>(commands, _skeleton, dof_names, _dof_map);
     }
 
+    DofView Robot::dof_view(const std::vector<std::string>& dof_names) const
+    {
+        DofView view;
+        view._dof_names = dof_names;
+        // check the names right away
+        dof_indices(view);
+        return view;
+    }
+
+    Eigen::VectorXd Robot::positions(const DofView& view)
+    {
+        if (view.all_dofs())
+            return _skeleton->getPositions();
+        return detail::dof_data<0>(_skeleton, dof_indices(view));
+    }
+
+    void Robot::set_positions(const Eigen::VectorXd& positions, const DofView& view)
+    {
+        if (view.all_dofs())
+            return set_positions(positions);
+        detail::set_dof_data<0>(positions, _skeleton, dof_indices(view));
+    }
+
+    Eigen::VectorXd Robot::velocities(const DofView& view)
+    {
+        if (view.all_dofs())
+            return _skeleton->getVelocities();
+        return detail::dof_data<1>(_skeleton, dof_indices(view));
+    }
+
+    void Robot::set_velocities(const Eigen::VectorXd& velocities, const DofView& view)
+    {
+        if (view.all_dofs())
+            return set_velocities(velocities);
+        detail::set_dof_data<1>(velocities, _skeleton, dof_indices(view));
+    }
+
+    Eigen::VectorXd Robot::accelerations(const DofView& view)
+    {
+        if (view.all_dofs())
+            return _skeleton->getAccelerations();
+        return detail::dof_data<2>(_skeleton, dof_indices(view));
+    }
+
+    void Robot::set_accelerations(const Eigen::VectorXd& accelerations, const DofView& view)
+    {
+        if (view.all_dofs())
+            return set_accelerations(accelerations);
+        detail::set_dof_data<2>(accelerations, _skeleton, dof_indices(view));
+    }
+
+    Eigen::VectorXd Robot::forces(const DofView& view)
+    {
+        if (view.all_dofs())
+            return _skeleton->getForces();
+        return detail::dof_data<3>(_skeleton, dof_indices(view));
+    }
+
+    void Robot::set_forces(const Eigen::VectorXd& forces, const DofView& view)
+    {
+        if (view.all_dofs())
+            return set_forces(forces);
+        detail::set_dof_data<3>(forces, _skeleton, dof_indices(view));
+    }
+
+    Eigen::VectorXd Robot::commands(const DofView& view)
+    {
+        if (view.all_dofs())
+            return _skeleton->getCommands();
+        return detail::dof_data<4>(_skeleton, dof_indices(view));
+    }
+
+    void Robot::set_commands(const Eigen::VectorXd& commands, const DofView& view)
+    {
+        if (view.all_dofs())
+            return set_commands(commands);
+        detail::set_dof_data<4>(commands, _skeleton, dof_indices(view));
+    }
+
+    void Robot::positions_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view) const
+    {
+        detail::dof_data_into<0>(out, _skeleton, view.all_dofs() ? nullptr : &dof_indices(view));
+    }
+
+    void Robot::velocities_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view) const
+    {
+        detail::dof_data_into<1>(out, _skeleton, view.all_dofs() ? nullptr : &dof_indices(view));
+    }
+
+    void Robot::accelerations_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view) const
+    {
+        detail::dof_data_into<2>(out, _skeleton, view.all_dofs() ? nullptr : &dof_indices(view));
+    }
+
+    void Robot::forces_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view) const
+    {
+        detail::dof_data_into<3>(out, _skeleton, view.all_dofs() ? nullptr : &dof_indices(view));
+    }
+
+    void Robot::commands_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view) const
+    {
+        detail::dof_data_into<4>(out, _skeleton, view.all_dofs() ? nullptr : &dof_indices(view));
+    }
+
+    void Robot::state_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view) const
+    {
+        size_t size = view.all_dofs() ? _skeleton->getNumDofs() : dof_indices(view).size();
+        ROBOT_DART_ASSERT(static_cast<size_t>(out.size()) == 2 * size, "state_into: size of the buffer is not twice the number of DoFs", );
+        positions_into(out.head(size), view);
+        velocities_into(out.tail(size), view);
+    }
+
     std::pair<Eigen::Vector6d, Eigen::Vector6d> Robot::force_torque(size_t joint_index) const
     {
         ROBOT_DART_ASSERT(joint_index < _skeleton->getNumJoints(), "Joint index out of bounds", {});
@@ -803,6 +1093,26 @@ namespace robot_dart {
         bd->addExtTorque(torque, local);
     }
 
+    void Robot::set_external_wrenches(const std::vector<size_t>& body_indices, const Eigen::Ref<const wrenches_t>& wrenches, bool local)
+    {
+        _external_wrenches(body_indices, wrenches, local, false);
+    }
+
+    void Robot::set_external_wrenches(const BodyView& view, const Eigen::Ref<const wrenches_t>& wrenches, bool local)
+    {
+        _external_wrenches(body_indices(view), wrenches, local, false);
+    }
+
+    void Robot::add_external_wrenches(const std::vector<size_t>& body_indices, const Eigen::Ref<const wrenches_t>& wrenches, bool local)
+    {
+        _external_wrenches(body_indices, wrenches, local, true);
+    }
+
+    void Robot::add_external_wrenches(const BodyView& view, const Eigen::Ref<const wrenches_t>& wrenches, bool local)
+    {
+        _external_wrenches(body_indices(view), wrenches, local, true);
+    }
+
     void Robot::clear_external_forces()
     {
         _skeleton->clearExternalForces();
@@ -837,6 +1147,66 @@ namespace robot_dart {
         return _skeleton->getBodyNode(body_index)->getWorldTransform();
     }
 
+    BodyView Robot::body_view(const std::vector<std::string>& body_names) const
+    {
+        BodyView view;
+        view._body_names = body_names;
+        // check the names right away
+        body_indices(view);
+        return view;
+    }
+
+    const std::vector<size_t>& Robot::body_indices(const BodyView& view) const
+    {
+        // the bodies can also be changed directly in the skeleton
+        if (view._version != _dof_map_version || view._num_bodies != _skeleton->getNumBodyNodes()) {
+            view._indices.clear();
+            // no names: all the bodies
+            if (view.all_bodies())
+                for (size_t i = 0; i < _skeleton->getNumBodyNodes(); i++)
+                    view._indices.push_back(i);
+            for (auto& name : view._body_names) {
+                auto bd = _skeleton->getBodyNode(name);
+                ROBOT_DART_EXCEPTION_ASSERT(bd != nullptr, "BodyView: " + name + " does not exist in skeleton");
+                view._indices.push_back(bd->getIndexInSkeleton());
+            }
+            view._version = _dof_map_version;
+            view._num_bodies = _skeleton->getNumBodyNodes();
+        }
+        return view._indices;
+    }
+
+    void Robot::body_poses_into(poses_t& out, const BodyView& view) const
+    {
+        const auto& indices = body_indices(view);
+        out.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); i++)
+            out[i] = _skeleton->getBodyNode(indices[i])->getWorldTransform();
+    }
+
+    void Robot::body_twists_into(Eigen::Ref<Eigen::MatrixXd> out, const BodyView& view) const
+    {
+        const auto& indices = body_indices(view);
+        ROBOT_DART_ASSERT(out.rows() == 6 && static_cast<size_t>(out.cols()) == indices.size(), "body_twists_into: the buffer must be 6 x the number of bodies", );
+        for (size_t i = 0; i < indices.size(); i++)
+            out.col(i) = _skeleton->getBodyNode(indices[i])->getSpatialVelocity(dart::dynamics::Frame::World(), dart::dynamics::Frame::World());
+    }
+
+    void Robot::body_linear_jacobians_into(Eigen::Ref<Eigen::MatrixXd> out, const BodyView& view) const
+    {
+        const auto& indices = body_indices(view);
+        ROBOT_DART_ASSERT(static_cast<size_t>(out.rows()) == 3 * indices.size() && static_cast<size_t>(out.cols()) == _skeleton->getNumDofs(), "body_linear_jacobians_into: the buffer must be 3 * the number of bodies x the number of DoFs", );
+        out.setZero();
+        for (size_t i = 0; i < indices.size(); i++) {
+            auto bd = _skeleton->getBodyNode(indices[i]);
+            // cached by DART (angular rows first), one column per DoF the body depends on
+            const auto& jac = bd->getWorldJacobian();
+            const auto& dofs = bd->getDependentGenCoordIndices();
+            for (size_t j = 0; j < dofs.size(); j++)
+                out.block<3, 1>(3 * i, dofs[j]) = jac.block<3, 1>(3, j);
+        }
+    }
+
     std::vector<std::string> Robot::body_names() const
     {
         std::vector<std::string> names;
@@ -900,6 +1270,8 @@ namespace robot_dart {
     void Robot::update_joint_dof_maps()
     {
         // DoFs
+        _dof_map_version = detail::next_version();
+        _update_dof_names();
         _dof_map.clear();
         for (size_t i = 0; i < _skeleton->getNumDofs(); ++i)
             _dof_map[_skeleton->getDof(i)->getName()] = i;
@@ -920,58 +1292,24 @@ namespace robot_dart {
         return _joint_map;
     }
 
-    std::vector<std::string> Robot::dof_names(bool filter_mimics, bool filter_locked, bool filter_passive) const
+    const std::vector<std::string>& Robot::dof_names(bool filter_mimics, bool filter_locked, bool filter_passive) const
     {
-        std::vector<std::string> names;
-        for (auto& dof : _skeleton->getDofs()) {
-            auto jt = dof->getJoint();
-            if ((!filter_mimics
-#if DART_VERSION_AT_LEAST(6, 7, 0)
-                    || jt->getActuatorType() != dart::dynamics::Joint::MIMIC
-#else
-                    || true
-#endif
-                    )
-                && (!filter_locked || jt->getActuatorType() != dart::dynamics::Joint::LOCKED)
-                && (!filter_passive || jt->getActuatorType() != dart::dynamics::Joint::PASSIVE))
-                names.push_back(dof->getName());
-        }
-        return names;
+        return _dof_names[(filter_mimics ? 1 : 0) + (filter_locked ? 2 : 0) + (filter_passive ? 4 : 0)];
     }
 
-    std::vector<std::string> Robot::mimic_dof_names() const
+    const std::vector<std::string>& Robot::mimic_dof_names() const
     {
-        std::vector<std::string> names;
-#if DART_VERSION_AT_LEAST(6, 7, 0)
-        for (auto& dof : _skeleton->getDofs()) {
-            auto jt = dof->getJoint();
-            if (jt->getActuatorType() == dart::dynamics::Joint::MIMIC)
-                names.push_back(dof->getName());
-        }
-#endif
-        return names;
+        return _dof_names[8];
     }
 
-    std::vector<std::string> Robot::locked_dof_names() const
+    const std::vector<std::string>& Robot::locked_dof_names() const
     {
-        std::vector<std::string> names;
-        for (auto& dof : _skeleton->getDofs()) {
-            auto jt = dof->getJoint();
-            if (jt->getActuatorType() == dart::dynamics::Joint::LOCKED)
-                names.push_back(dof->getName());
-        }
-        return names;
+        return _dof_names[9];
     }
 
-    std::vector<std::string> Robot::passive_dof_names() const
+    const std::vector<std::string>& Robot::passive_dof_names() const
     {
-        std::vector<std::string> names;
-        for (auto& dof : _skeleton->getDofs()) {
-            auto jt = dof->getJoint();
-            if (jt->getActuatorType() == dart::dynamics::Joint::PASSIVE)
-                names.push_back(dof->getName());
-        }
-        return names;
+        return _dof_names[10];
     }
 
     std::string Robot::dof_name(size_t dof_index) const
@@ -1046,11 +1384,23 @@ namespace robot_dart {
         }
     }
 
-    void Robot::set_cast_shadows(bool cast_shadows) { _cast_shadows = cast_shadows; }
+    void Robot::set_cast_shadows(bool cast_shadows)
+    {
+        if (_cast_shadows != cast_shadows) {
+            _cast_shadows = cast_shadows;
+            _gui_version++;
+        }
+    }
 
     bool Robot::cast_shadows() const { return _cast_shadows; }
 
-    void Robot::set_ghost(bool ghost) { _is_ghost = ghost; }
+    void Robot::set_ghost(bool ghost)
+    {
+        if (_is_ghost != ghost) {
+            _is_ghost = ghost;
+            _gui_version++;
+        }
+    }
 
     bool Robot::ghost() const { return _is_ghost; }
 
@@ -1060,35 +1410,43 @@ namespace robot_dart {
         ROBOT_DART_ASSERT(bd, "Body name does not exist in skeleton", );
         std::pair<dart::dynamics::BodyNode*, double> p = {bd, size};
         auto iter = std::find(_axis_shapes.begin(), _axis_shapes.end(), p);
-        if (iter == _axis_shapes.end())
+        if (draw && iter == _axis_shapes.end()) {
             _axis_shapes.push_back(p);
+            _gui_version++;
+        }
+        else if (!draw && iter != _axis_shapes.end()) {
+            _axis_shapes.erase(iter);
+            _gui_version++;
+        }
     }
 
     void Robot::remove_all_drawing_axis()
     {
-        _axis_shapes.clear();
+        if (!_axis_shapes.empty()) {
+            _axis_shapes.clear();
+            _gui_version++;
+        }
     }
 
     const std::vector<std::pair<dart::dynamics::BodyNode*, double>>& Robot::drawing_axes() const { return _axis_shapes; }
 
+    size_t Robot::gui_version() const { return _gui_version; }
+
     dart::dynamics::SkeletonPtr Robot::_load_model(const std::string& filename, const std::vector<std::pair<std::string, std::string>>& packages, bool is_urdf_string)
     {
-        // Remove spaces from beginning of the filename/path
-        std::string model_file = filename;
-        model_file.erase(model_file.begin(), std::find_if(model_file.begin(), model_file.end(), [](int ch) {
-            return !std::isspace(ch);
-        }));
-
-        if (model_file[0] != '/') {
-            constexpr size_t max_size = 512;
-            char buff[max_size];
-            auto val = getcwd(buff, max_size);
-            ROBOT_DART_ASSERT(val, "Something bad happenned when trying to read current path", nullptr);
-            model_file = std::string(buff) + "/" + model_file;
-        }
-
+        std::string model_file;
         dart::dynamics::SkeletonPtr tmp_skel;
         if (!is_urdf_string) {
+            model_file = ModelCache::absolute_path(filename);
+            ROBOT_DART_ASSERT(!model_file.empty(), "Something bad happenned when trying to read current path", nullptr);
+
+            tmp_skel = ModelCache::instance().get(model_file, packages, _robot_name);
+            if (tmp_skel) {
+                // already processed (joint limits and color mode)
+                tmp_skel->setName(_robot_name);
+                return tmp_skel;
+            }
+
             std::string extension = model_file.substr(model_file.find_last_of(".") + 1);
             if (extension == "urdf") {
                 dart::io::DartLoader loader;
@@ -1135,21 +1493,34 @@ namespace robot_dart {
 
         _set_color_mode(dart::dynamics::MeshShape::ColorMode::SHAPE_COLOR, tmp_skel);
 
+        if (!is_urdf_string)
+            ModelCache::instance().insert(model_file, packages, _robot_name, tmp_skel);
+
         return tmp_skel;
     }
 
     void Robot::_set_damages(const std::vector<RobotDamage>& damages)
     {
         _damages = damages;
-        for (auto dmg : _damages) {
+        for (auto& dmg : _damages) {
+            dart::dynamics::Joint* jnt = nullptr;
+            if (dmg.joint_index >= 0) {
+                ROBOT_DART_EXCEPTION_ASSERT(static_cast<size_t>(dmg.joint_index) < _skeleton->getNumJoints(), "RobotDamage: joint index out of bounds");
+                jnt = _skeleton->getJoint(dmg.joint_index);
+                // keep the name for damages()
+                dmg.data = jnt->getName();
+            }
+            else
+                jnt = _skeleton->getJoint(dmg.data);
+            ROBOT_DART_EXCEPTION_ASSERT(jnt != nullptr, "RobotDamage: " + dmg.data + " is not a joint of the robot");
+
             if (dmg.type == "blocked_joint") {
-                auto jnt = _skeleton->getJoint(dmg.data);
                 if (dmg.extra)
                     jnt->setPosition(0, *((double*)dmg.extra));
                 jnt->setActuatorType(dart::dynamics::Joint::LOCKED);
             }
             else if (dmg.type == "free_joint") {
-                _skeleton->getJoint(dmg.data)->setActuatorType(dart::dynamics::Joint::PASSIVE);
+                jnt->setActuatorType(dart::dynamics::Joint::PASSIVE);
             }
         }
 
@@ -1187,6 +1558,7 @@ namespace robot_dart {
         if (override_mimic || jt->getActuatorType() != dart::dynamics::Joint::MIMIC)
 #endif
             jt->setActuatorType(type);
+        _update_dof_names();
     }
 
     void Robot::_set_actuator_types(const std::vector<dart::dynamics::Joint::ActuatorType>& types, bool override_mimic, bool override_base)
@@ -1204,6 +1576,7 @@ namespace robot_dart {
 #endif
                 jt->setActuatorType(types[i]);
         }
+        _update_dof_names();
     }
 
     void Robot::_set_actuator_types(dart::dynamics::Joint::ActuatorType type, bool override_mimic, bool override_base)
@@ -1220,6 +1593,79 @@ namespace robot_dart {
 #endif
                 jt->setActuatorType(type);
         }
+        _update_dof_names();
+    }
+
+    const std::vector<size_t>& Robot::dof_indices(const DofView& view) const
+    {
+        if (view._version != _dof_map_version) {
+            view._indices.clear();
+            // no names: all the DoFs
+            if (view.all_dofs())
+                for (size_t i = 0; i < _skeleton->getNumDofs(); i++)
+                    view._indices.push_back(i);
+            for (auto& name : view._dof_names) {
+                auto it = _dof_map.find(name);
+                ROBOT_DART_EXCEPTION_ASSERT(it != _dof_map.end(), "DofView: " + name + " is not in dof_map");
+                view._indices.push_back(it->second);
+            }
+            view._version = _dof_map_version;
+        }
+        return view._indices;
+    }
+
+    void Robot::_update_dof_names()
+    {
+        _dof_names_version = detail::next_version();
+
+        _dof_names.resize(11);
+        for (auto& names : _dof_names)
+            names.clear();
+
+        for (auto& dof : _skeleton->getDofs()) {
+            auto type = dof->getJoint()->getActuatorType();
+#if DART_VERSION_AT_LEAST(6, 7, 0)
+            bool mimic = (type == dart::dynamics::Joint::MIMIC);
+#else
+            bool mimic = false;
+#endif
+            bool locked = (type == dart::dynamics::Joint::LOCKED);
+            bool passive = (type == dart::dynamics::Joint::PASSIVE);
+
+            // a DoF is in every list whose filters do not exclude it
+            for (size_t filters = 0; filters < 8; filters++)
+                if (!((filters & 1) && mimic) && !((filters & 2) && locked) && !((filters & 4) && passive))
+                    _dof_names[filters].push_back(dof->getName());
+            if (mimic)
+                _dof_names[8].push_back(dof->getName());
+            if (locked)
+                _dof_names[9].push_back(dof->getName());
+            if (passive)
+                _dof_names[10].push_back(dof->getName());
+        }
+
+    }
+
+    void Robot::_external_wrenches(const std::vector<size_t>& body_indices, const Eigen::Ref<const wrenches_t>& wrenches, bool local, bool add)
+    {
+        ROBOT_DART_ASSERT(static_cast<size_t>(wrenches.rows()) == body_indices.size(), "external_wrenches: the number of wrenches is not the same as the number of bodies", );
+        size_t num_bodies = _skeleton->getNumBodyNodes();
+        for (size_t index : body_indices)
+            ROBOT_DART_ASSERT(index < num_bodies, "external_wrenches: BodyNode index out of bounds", );
+
+        for (size_t i = 0; i < body_indices.size(); i++) {
+            auto bd = _skeleton->getBodyNode(body_indices[i]);
+            Eigen::Vector3d torque = wrenches.row(i).head<3>().transpose();
+            Eigen::Vector3d force = wrenches.row(i).tail<3>().transpose();
+            if (add) {
+                bd->addExtForce(force, Eigen::Vector3d::Zero(), local, true);
+                bd->addExtTorque(torque, local);
+            }
+            else {
+                bd->setExtForce(force, Eigen::Vector3d::Zero(), local, true);
+                bd->setExtTorque(torque, local);
+            }
+        }
     }
 
     dart::dynamics::Joint::ActuatorType Robot::_actuator_type(size_t joint_index) const
@@ -6,17 +6,25 @@
 #include <dart/dynamics/MeshShape.hpp>
 #include <dart/dynamics/Skeleton.hpp>
 
+#include <robot_dart/body_view.hpp>
+#include <robot_dart/dof_view.hpp>
+
 namespace robot_dart {
     namespace control {
         class RobotControl;
     }
 
+    // type: "blocked_joint" (extra: optional double*, position of the blocked joint) or "free_joint"
+    // the joint is given by its name (data) or by its index in the skeleton (joint_index)
     struct RobotDamage {
         RobotDamage() {}
         RobotDamage(const std::string& type, const std::string& data, void* extra = nullptr) : type(type), data(data), extra(extra) {}
+        RobotDamage(const std::string& type, size_t joint_index, void* extra = nullptr) : type(type), joint_index(static_cast<int>(joint_index)), extra(extra) {}
 
         std::string type;
         std::string data;
+        // used instead of data if >= 0
+        int joint_index = -1;
         void* extra = nullptr;
     };
 
@@ -33,6 +41,11 @@ namespace robot_dart {
 
         std::vector<RobotDamage> damages() const;
 
+        // replace the mesh collision shapes (of all the bodies, or of body_names) with simpler ones; the visual shapes are kept
+        // type can be: convex_hull (cached on disk, see CollisionShapeCache), box (bounding box) or capsule (bounding capsule)
+        // call it before adding the robot to the simulation; returns the number of replaced shapes
+        size_t simplify_collision_shapes(const std::string& type = "convex_hull", const std::vector<std::string>& body_names = {});
+
         const std::string& name() const;
 
         void update(double t);
@@ -114,6 +127,36 @@ namespace robot_dart {
         Eigen::VectorXd commands(const std::vector<std::string>& dof_names = {});
         void set_commands(const Eigen::VectorXd& commands, const std::vector<std::string>& dof_names = {});
 
+        // same as above with the indices of the DoFs resolved once (see DofView)
+        DofView dof_view(const std::vector<std::string>& dof_names) const;
+        // indices of the DoFs of a view in the skeleton (resolved again if the DoFs changed since the last call)
+        const std::vector<size_t>& dof_indices(const DofView& view) const;
+
+        // allocation-free versions: write into a preallocated buffer of the size of the view (e.g., a segment of an observation vector)
+        // DART keeps the state per joint (not contiguously for the whole skeleton), so the values are gathered DoF by DoF
+        void positions_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view = DofView()) const;
+        void velocities_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view = DofView()) const;
+        void accelerations_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view = DofView()) const;
+        void forces_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view = DofView()) const;
+        void commands_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view = DofView()) const;
+        // positions then velocities of the DoFs of the view (out: 2 * size of the view)
+        void state_into(Eigen::Ref<Eigen::VectorXd> out, const DofView& view = DofView()) const;
+
+        Eigen::VectorXd positions(const DofView& view);
+        void set_positions(const Eigen::VectorXd& positions, const DofView& view);
+
+        Eigen::VectorXd velocities(const DofView& view);
+        void set_velocities(const Eigen::VectorXd& velocities, const DofView& view);
+
+        Eigen::VectorXd accelerations(const DofView& view);
+        void set_accelerations(const Eigen::VectorXd& accelerations, const DofView& view);
+
+        Eigen::VectorXd forces(const DofView& view);
+        void set_forces(const Eigen::VectorXd& forces, const DofView& view);
+
+        Eigen::VectorXd commands(const DofView& view);
+        void set_commands(const Eigen::VectorXd& commands, const DofView& view);
+
         std::pair<Eigen::Vector6d, Eigen::Vector6d> force_torque(size_t joint_index) const;
 
         void set_external_force(const std::string& body_name, const Eigen::Vector3d& force, const Eigen::Vector3d& offset = Eigen::Vector3d::Zero(), bool force_local = false, bool offset_local = true);
@@ -126,6 +169,14 @@ namespace robot_dart {
         void add_external_torque(const std::string& body_name, const Eigen::Vector3d& torque, bool local = false);
         void add_external_torque(size_t body_index, const Eigen::Vector3d& torque, bool local = false);
 
+        // batched versions: one wrench (torque, force) per row, in the same order as the bodies, applied at the origin of the bodies
+        // local == false: world frame, otherwise frame of each body; everything is checked before the first write
+        using wrenches_t = Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor>;
+        void set_external_wrenches(const std::vector<size_t>& body_indices, const Eigen::Ref<const wrenches_t>& wrenches, bool local = false);
+        void set_external_wrenches(const BodyView& view, const Eigen::Ref<const wrenches_t>& wrenches, bool local = false);
+        void add_external_wrenches(const std::vector<size_t>& body_indices, const Eigen::Ref<const wrenches_t>& wrenches, bool local = false);
+        void add_external_wrenches(const BodyView& view, const Eigen::Ref<const wrenches_t>& wrenches, bool local = false);
+
         void clear_external_forces();
 
         Eigen::Vector6d external_forces(const std::string& body_name) const;
@@ -134,6 +185,18 @@ namespace robot_dart {
         Eigen::Isometry3d body_pose(const std::string& body_name) const;
         Eigen::Isometry3d body_pose(size_t body_index) const;
 
+        // batched queries on a set of bodies resolved once (see BodyView); the empty view is all the bodies
+        using poses_t = std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>>;
+        BodyView body_view(const std::vector<std::string>& body_names) const;
+        // indices of the bodies of a view in the skeleton (resolved again if the bodies changed since the last call)
+        const std::vector<size_t>& body_indices(const BodyView& view) const;
+        // world transforms (out is resized to the size of the view, i.e., it only allocates the first time)
+        void body_poses_into(poses_t& out, const BodyView& view = BodyView()) const;
+        // spatial velocities of the body origins in the world frame, one column per body (out: 6 x size of the view, angular first)
+        void body_twists_into(Eigen::Ref<Eigen::MatrixXd> out, const BodyView& view = BodyView()) const;
+        // linear Jacobians of the body origins in the world frame, stacked (out: 3 * size of the view x num_dofs)
+        void body_linear_jacobians_into(Eigen::Ref<Eigen::MatrixXd> out, const BodyView& view = BodyView()) const;
+
         std::vector<std::string> body_names() const;
         std::string body_name(size_t body_index) const;
         void set_body_name(size_t body_index, const std::string& body_name);
@@ -149,12 +212,17 @@ namespace robot_dart {
         const std::unordered_map<std::string, size_t>& dof_map() const;
         const std::unordered_map<std::string, size_t>& joint_map() const;
 
-        std::vector<std::string> dof_names(bool filter_mimics = false, bool filter_locked = false, bool filter_passive = false) const;
-        std::vector<std::string> mimic_dof_names() const;
-        std::vector<std::string> locked_dof_names() const;
-        std::vector<std::string> passive_dof_names() const;
+        // the lists are cached; they are rebuilt by update_joint_dof_maps() and when the actuator types change
+        // (call update_joint_dof_maps() after changing the actuator types directly in the skeleton):
+        // the getters only read them, and the returned references see the rebuilt lists (copy them to keep the current ones)
+        const std::vector<std::string>& dof_names(bool filter_mimics = false, bool filter_locked = false, bool filter_passive = false) const;
+        const std::vector<std::string>& mimic_dof_names() const;
+        const std::vector<std::string>& locked_dof_names() const;
+        const std::vector<std::string>& passive_dof_names() const;
         std::string dof_name(size_t dof_index) const;
         size_t dof_index(const std::string& dof_name) const;
+        // changes each time the lists above are rebuilt (unique among all the robots: lists derived from them can be cached)
+        size_t dof_names_version() const { return _dof_names_version; }
 
         std::vector<std::string> joint_names() const;
         std::string joint_name(size_t joint_index) const;
@@ -174,6 +242,8 @@ namespace robot_dart {
         void set_draw_axis(const std::string& body_name, double size = 0.25, bool draw = true);
         void remove_all_drawing_axis();
         const std::vector<std::pair<dart::dynamics::BodyNode*, double>>& drawing_axes() const;
+        // incremented every time one of the GUI options above changes
+        size_t gui_version() const;
 
         // helper functions
         // pose: Orientation-Position
@@ -182,6 +252,9 @@ namespace robot_dart {
         static std::shared_ptr<Robot> create_ellipsoid(const Eigen::Vector3d& dims, const Eigen::Vector6d& pose = Eigen::Vector6d::Zero(), const std::string& type = "free", double mass = 1.0, const Eigen::Vector4d& color = dart::Color::Red(1.0), const std::string& ellipsoid_name = "ellipsoid");
 
     protected:
+        friend class DamageVariants;
+        friend class RobotPrototype;
+
         dart::dynamics::SkeletonPtr _load_model(const std::string& filename, const std::vector<std::pair<std::string, std::string>>& packages = std::vector<std::pair<std::string, std::string>>(), bool is_urdf_string = false);
 
         void _set_damages(const std::vector<RobotDamage>& damages);
@@ -194,15 +267,25 @@ namespace robot_dart {
 
         dart::dynamics::Joint::ActuatorType _actuator_type(size_t joint_index) const;
         std::vector<dart::dynamics::Joint::ActuatorType> _actuator_types() const;
+        void _update_dof_names();
+        void _external_wrenches(const std::vector<size_t>& body_indices, const Eigen::Ref<const wrenches_t>& wrenches, bool local, bool add);
 
         std::string _robot_name;
         dart::dynamics::SkeletonPtr _skeleton;
         std::vector<RobotDamage> _damages;
         std::vector<std::shared_ptr<control::RobotControl>> _controllers;
         std::unordered_map<std::string, size_t> _dof_map, _joint_map;
+        // new version for every update_joint_dof_maps(), unique among all the robots (invalidates the DoF and body views)
+        size_t _dof_map_version = 0;
+        // DoF names for each combination of filters (mimic: 1, locked: 2, passive: 4), then the mimic, locked and passive DoFs
+        std::vector<std::vector<std::string>> _dof_names;
+        size_t _dof_names_version = 0;
+        // buffers of update() (kept to avoid allocations in the control loop)
+        Eigen::VectorXd _commands, _controller_commands;
         bool _cast_shadows;
         bool _is_ghost;
         std::vector<std::pair<dart::dynamics::BodyNode*, double>> _axis_shapes;
+        size_t _gui_version = 0;
     };
 } // namespace robot_dart
 
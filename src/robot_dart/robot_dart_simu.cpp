@@ -1,14 +1,19 @@
 #include "robot_dart_simu.hpp"
 #include "gui_data.hpp"
+#include "recorder.hpp"
 #include "utils.hpp"
 
+#include <robot_dart/control/robot_control.hpp>
+
 #include <dart/collision/CollisionFilter.hpp>
+#include <dart/collision/CollisionGroup.hpp>
 #include <dart/collision/CollisionObject.hpp>
 #include <dart/collision/dart/DARTCollisionDetector.hpp>
 #include <dart/collision/fcl/FCLCollisionDetector.hpp>
 #include <dart/config.hpp>
 #include <dart/constraint/ConstraintSolver.hpp>
 #include <dart/dynamics/BoxShape.hpp>
+#include <dart/dynamics/DegreeOfFreedom.hpp>
 #include <dart/dynamics/WeldJoint.hpp>
 
 #if (HAVE_BULLET == 1)
@@ -19,9 +24,16 @@
 #include <dart/collision/ode/OdeCollisionDetector.hpp>
 #endif
 
+#include <chrono>
+#include <limits>
+
 namespace robot_dart {
     namespace collision_filter {
         // This is inspired from ign-physics: https://bitbucket.org/ignitionrobotics/ign-physics/src/0feb6cdf616e38ed919692031b9b9b11e19efddd/dartsim/src/EntityManagementFeatures.cc#lines-38:96
+        // ignoresCollision() runs for every candidate pair of every step: the ShapeNodes get a compact id when their robot is added
+        // and the masks are stored in a dense array indexed by this id. DART does not let us store the id in the ShapeNode, so it is
+        // found in a small open-addressing table (usually in the first slot): checking a pair is two loads per shape and an AND,
+        // done before the (more expensive) checks of BodyNodeCollisionFilter.
         class BitmaskContactFilter : public dart::collision::BodyNodeCollisionFilter {
         public:
             using DartCollisionConstPtr = const dart::collision::CollisionObject*;
@@ -32,23 +44,40 @@ namespace robot_dart {
             // This function follows DART's coding style as it needs to override a function
             bool ignoresCollision(DartCollisionConstPtr object1, DartCollisionConstPtr object2) const override
             {
-                auto shape_node1 = object1->getShapeFrame()->asShapeNode();
-                auto shape_node2 = object2->getShapeFrame()->asShapeNode();
-
-                if (dart::collision::BodyNodeCollisionFilter::ignoresCollision(object1, object2))
+                if (!interact(_mask(object1->getShapeFrame()), _mask(object2->getShapeFrame())))
                     return true;
-
-                auto shape1_iter = _bitmask_map.find(shape_node1);
-                auto shape2_iter = _bitmask_map.find(shape_node2);
-                if (shape1_iter != _bitmask_map.end() && shape2_iter != _bitmask_map.end() && ((shape1_iter->second & shape2_iter->second) == 0))
+                // neither of the skeletons can move (e.g., a sleeping robot on the floor, see RobotDARTSimu::enable_sleeping())
+                if (_skip_static_pairs && !_movable(object1) && !_movable(object2))
                     return true;
 
-                return false;
+                return dart::collision::BodyNodeCollisionFilter::ignoresCollision(object1, object2);
+            }
+
+            // gives an id to all the ShapeNodes of the skeleton (called when a robot is added)
+            void add_skeleton(const dart::dynamics::SkeletonPtr& skel)
+            {
+                for (std::size_t i = 0; i < skel->getNumShapeNodes(); ++i)
+                    _id(skel->getShapeNode(i));
+            }
+
+            // frees the ids of the ShapeNodes of the skeleton (called when a robot is removed)
+            void remove_skeleton(const dart::dynamics::SkeletonPtr& skel)
+            {
+                for (std::size_t i = 0; i < skel->getNumShapeNodes(); ++i) {
+                    const Slot& slot = _table[_find(skel->getShapeNode(i))];
+                    if (slot.shape == nullptr)
+                        continue;
+                    _shapes[slot.id] = nullptr;
+                    _masks[slot.id] = _no_mask;
+                    _free_ids.push_back(slot.id);
+                }
+                // linear probing: rebuild the table instead of leaving holes in the probe sequences
+                _rehash(_table.size());
             }
 
             void add_to_map(DartShapeConstPtr shape, const uint16_t mask)
             {
-                _bitmask_map[shape] = mask;
+                _masks[_id(shape)] = mask;
             }
 
             void add_to_map(dart::dynamics::SkeletonPtr skel, const uint16_t mask)
@@ -61,9 +90,9 @@ namespace robot_dart {
 
             void remove_from_map(DartShapeConstPtr shape)
             {
-                auto shape_iter = _bitmask_map.find(shape);
-                if (shape_iter != _bitmask_map.end())
-                    _bitmask_map.erase(shape_iter);
+                const Slot& slot = _table[_find(shape)];
+                if (slot.shape != nullptr)
+                    _masks[slot.id] = _no_mask;
             }
 
             void remove_from_map(dart::dynamics::SkeletonPtr skel)
@@ -74,20 +103,173 @@ namespace robot_dart {
                 }
             }
 
-            void clear_all() { _bitmask_map.clear(); }
+            void clear_all() { std::fill(_masks.begin(), _masks.end(), _no_mask); }
+
+            // shapes without mask have their upper bits set: they are never filtered out by the masks
+            static bool interact(uint32_t mask1, uint32_t mask2) { return ((mask1 & mask2) | ((mask1 | mask2) & _no_mask)) != 0; }
+
+            // mask as stored (with the upper bits set when there is no mask): the OR of the masks of several shapes
+            // interacts with another one if at least one of the shapes does
+            uint32_t raw_mask(DartShapeConstPtr shape) const { return _mask(shape); }
+
+            void set_skip_static_pairs(bool skip) { _skip_static_pairs = skip; }
 
             uint16_t mask(DartShapeConstPtr shape) const
             {
-                auto shape_iter = _bitmask_map.find(shape);
-                if (shape_iter != _bitmask_map.end())
-                    return shape_iter->second;
-                return 0xff;
+                uint32_t mask = _mask(shape);
+                if (mask & _no_mask)
+                    return 0xff;
+                return static_cast<uint16_t>(mask);
             }
 
         private:
+            using ShapeConstPtr = const dart::dynamics::ShapeFrame*;
+            static constexpr uint32_t _no_mask = 0xffff0000;
+
+            // value-initialized (Slot()) when empty
+            struct Slot {
+                ShapeConstPtr shape;
+                uint32_t id;
+            };
+
+            // slot of the shape, or empty slot where it would go (the table has a power-of-two size and is at most half full)
+            std::size_t _find(ShapeConstPtr shape) const
+            {
+                std::size_t slot = static_cast<std::size_t>((static_cast<uint64_t>(reinterpret_cast<uintptr_t>(shape)) * 0x9E3779B97F4A7C15ull) >> _shift);
+                while (_table[slot].shape != nullptr && _table[slot].shape != shape)
+                    slot = (slot + 1) & (_table.size() - 1);
+                return slot;
+            }
+
+            static bool _movable(DartCollisionConstPtr object)
+            {
+                auto shape_node = object->getShapeFrame()->asShapeNode();
+                if (!shape_node)
+                    return true;
+                auto skel = shape_node->getSkeleton();
+                return skel->isMobile() && skel->getNumDofs() > 0;
+            }
+
+            uint32_t _mask(ShapeConstPtr shape) const
+            {
+                const Slot& slot = _table[_find(shape)];
+                return slot.shape ? _masks[slot.id] : _no_mask;
+            }
+
+            uint32_t _id(ShapeConstPtr shape)
+            {
+                std::size_t slot = _find(shape);
+                if (_table[slot].shape != nullptr)
+                    return _table[slot].id;
+
+                uint32_t id;
+                if (_free_ids.empty()) {
+                    id = static_cast<uint32_t>(_shapes.size());
+                    _shapes.push_back(shape);
+                    _masks.push_back(_no_mask);
+                }
+                else {
+                    id = _free_ids.back();
+                    _free_ids.pop_back();
+                    _shapes[id] = shape;
+                }
+
+                if (2 * (_shapes.size() - _free_ids.size()) > _table.size())
+                    _rehash(2 * _table.size());
+                else
+                    _table[slot] = {shape, id};
+                return id;
+            }
+
+            void _rehash(std::size_t size)
+            {
+                _table.assign(size, Slot());
+                _shift = 64;
+                for (std::size_t s = size; s > 1; s >>= 1)
+                    _shift--;
+                for (uint32_t id = 0; id < _shapes.size(); id++)
+                    if (_shapes[id])
+                        _table[_find(_shapes[id])] = {_shapes[id], id};
+            }
+
             // We need ShapeNodes and not BodyNodes, since in DART collision checking is performed in ShapeNode-level
-            // in RobotDARTSimu, we only allow setting one mask per BodyNode; maybe we can improve the performance of this slightly
-            std::unordered_map<DartShapeConstPtr, uint16_t> _bitmask_map;
+            // ShapeNode -> id
+            std::vector<Slot> _table = std::vector<Slot>(16);
+            int _shift = 60;
+            // id -> ShapeNode, mask (16 bits, or _no_mask)
+            std::vector<ShapeConstPtr> _shapes;
+            std::vector<uint32_t> _masks;
+            std::vector<uint32_t> _free_ids;
+            bool _skip_static_pairs = false;
+        };
+
+        constexpr uint32_t BitmaskContactFilter::_no_mask;
+
+        // Broadphase pre-culling: the skeletons are split into DART collision groups (one per combination of masks, see
+        // RobotDARTSimu::enable_collision_groups()) and only the pairs of groups that can interact are given to the detector.
+        class CollisionGroups {
+        public:
+            virtual ~CollisionGroups() = default;
+
+            void set_groups(const dart::collision::CollisionGroup* target, const std::vector<std::shared_ptr<dart::collision::CollisionGroup>>& groups, const std::vector<std::pair<size_t, size_t>>& pairs)
+            {
+                _target = target;
+                _groups = groups;
+                _pairs = pairs;
+            }
+
+            void clear_groups() { set_groups(nullptr, {}, {}); }
+
+        protected:
+            // the (whole) group that is replaced by the groups: the one of the constraint solver
+            const dart::collision::CollisionGroup* _target = nullptr;
+            std::vector<std::shared_ptr<dart::collision::CollisionGroup>> _groups;
+            std::vector<std::pair<size_t, size_t>> _pairs;
+            dart::collision::CollisionResult _pair_result;
+        };
+
+        // Any DART collision detector, with the collision checks of the constraint solver split by groups
+        template <typename Detector>
+        class GroupedCollisionDetector : public Detector, public CollisionGroups {
+        public:
+            using Detector::collide;
+
+            static std::shared_ptr<GroupedCollisionDetector> create() { return std::shared_ptr<GroupedCollisionDetector>(new GroupedCollisionDetector()); }
+
+            // This function follows DART's coding style as it needs to override a function
+            bool collide(dart::collision::CollisionGroup* group, const dart::collision::CollisionOption& option, dart::collision::CollisionResult* result) override
+            {
+                if (group != _target || _groups.empty())
+                    return Detector::collide(group, option, result);
+
+                if (result)
+                    result->clear();
+
+                bool collision = false;
+                for (auto& pair : _pairs) {
+                    auto pair_result = result ? &_pair_result : nullptr;
+                    if (pair_result)
+                        pair_result->clear();
+
+                    bool c = (pair.first == pair.second) ? Detector::collide(_groups[pair.first].get(), option, pair_result)
+                                                         : Detector::collide(_groups[pair.first].get(), _groups[pair.second].get(), option, pair_result);
+                    if (!c)
+                        continue;
+                    collision = true;
+                    if (!result)
+                        break;
+
+                    for (std::size_t i = 0; i < pair_result->getNumContacts() && result->getNumContacts() < option.maxNumContacts; i++)
+                        result->addContact(pair_result->getContact(i));
+                    if (result->getNumContacts() >= option.maxNumContacts)
+                        break;
+                }
+
+                return collision;
+            }
+
+        protected:
+            GroupedCollisionDetector() = default;
         };
     } // namespace collision_filter
 
@@ -96,19 +278,26 @@ namespace robot_dart {
                                                     _break(false),
                                                     _scheduler(timestep),
                                                     _physics_freq(std::round(1. / timestep)),
-                                                    _control_freq(_physics_freq)
+                                                    _control_freq(_physics_freq),
+                                                    _termination_freq(_physics_freq)
     {
-        _world->getConstraintSolver()->setCollisionDetector(dart::collision::DARTCollisionDetector::create());
+        _world->getConstraintSolver()->setCollisionDetector(collision_filter::GroupedCollisionDetector<dart::collision::DARTCollisionDetector>::create());
         _world->getConstraintSolver()->getCollisionOption().collisionFilter = std::make_shared<collision_filter::BitmaskContactFilter>();
         _world->setTimeStep(timestep);
         _world->setTime(0.0);
         _graphics = std::make_shared<gui::Base>(this);
 
         _gui_data.reset(new simu::GUIData());
+
+        _physics_task = _scheduler.add_task(_physics_freq);
+        _control_task = _scheduler.add_task(_control_freq);
+        _graphics_task = _scheduler.add_task(_graphics_freq);
+        _termination_task = _scheduler.add_task(_termination_freq);
     }
 
     RobotDARTSimu::~RobotDARTSimu()
     {
+        _graphics->finish();
         _robots.clear();
         _descriptors.clear();
         _cameras.clear();
@@ -117,6 +306,7 @@ namespace robot_dart {
     void RobotDARTSimu::run(double max_duration, bool reset_commands)
     {
         _break = false;
+        _terminated_by = -1;
         double old_time = _world->getTime();
         double factor = _world->getTimeStep() / 2.;
 
@@ -128,27 +318,60 @@ namespace robot_dart {
 
     bool RobotDARTSimu::step_world(bool reset_commands)
     {
-        if (_scheduler(_physics_freq)) {
-            _world->step(reset_commands);
+        if (_scheduler.runs(_physics_task)) {
+            // skeletons can also be added directly to the world
+            if (_collision_groups && (_collision_groups_dirty || _world->getNumSkeletons() != _num_grouped_skeletons))
+                _update_collision_groups();
+
+            {
+                ROBOT_DART_PROFILE_PHASE(_profiler, WORLD_STEP);
+                if (_sleeping)
+                    _wake_up_robots();
+                _world->step(reset_commands);
+                if (_sleeping)
+                    _update_sleeping();
+            }
 
             // update descriptors
+            ROBOT_DART_PROFILE_PHASE(_profiler, DESCRIPTORS);
             for (auto& desc : _descriptors)
                 if (_old_index % desc->desc_dump() == 0)
                     desc->operator()();
         }
 
-        if (_scheduler(_control_freq)) {
+        if (!_termination_conditions.empty() && _scheduler.runs(_termination_task)) {
+            for (size_t i = 0; i < _termination_conditions.size(); i++) {
+                if (_termination_conditions[i].violated(_robots)) {
+                    _terminated_by = i;
+                    _break = true;
+                    break;
+                }
+            }
+        }
+
+        if (_scheduler.runs(_control_task)) {
             // update cameras (sensors)
+            ROBOT_DART_PROFILE_PHASE(_profiler, CAMERAS);
             for (auto& cam : _cameras)
                 cam->refresh();
         }
 
-        if (_scheduler(_graphics_freq)) {
-            _graphics->refresh();
+        if (_scheduler.runs(_graphics_task)) {
+            {
+                // the previous frame might still be drawn asynchronously (and read the GUI data)
+                ROBOT_DART_PROFILE_PHASE(_profiler, GRAPHICS_WAIT);
+                _graphics->finish();
+            }
 
-            for (auto& robot : _robots) {
-                _gui_data->update_robot(robot);
+            {
+                ROBOT_DART_PROFILE_PHASE(_profiler, GUI_DATA);
+                for (auto& robot : _robots) {
+                    _gui_data->update_robot(robot);
+                }
             }
+
+            ROBOT_DART_PROFILE_PHASE(_profiler, GRAPHICS);
+            _graphics->refresh();
         }
 
         _old_index++;
@@ -159,13 +382,26 @@ namespace robot_dart {
 
     bool RobotDARTSimu::step(bool reset_commands)
     {
-        if (_scheduler(_control_freq)) {
-            for (auto& robot : _robots) {
-                robot->update(_world->getTime());
+        if (_scheduler.runs(_control_task)) {
+            if (_recorder)
+                _recorder->record_state(*this);
+
+            {
+                ROBOT_DART_PROFILE_PHASE(_profiler, ROBOT_UPDATE);
+                for (auto& robot : _robots) {
+                    robot->update(_world->getTime());
+                }
             }
+
+            if (_recorder)
+                _recorder->record_commands(*this);
         }
 
-        return step_world(reset_commands);
+        bool ret = step_world(reset_commands);
+        if (_recorder)
+            _recorder->record_step(*this);
+
+        return ret;
     }
 
     std::shared_ptr<gui::Base> RobotDARTSimu::graphics() const
@@ -223,17 +459,32 @@ namespace robot_dart {
 
     void RobotDARTSimu::set_timestep(double timestep, bool update_control_freq)
     {
+        bool smaller = timestep < _world->getTimeStep();
         _world->setTimeStep(timestep);
+        int old_physics_freq = _physics_freq;
         _physics_freq = std::round(1. / timestep);
         if (update_control_freq)
             _control_freq = _physics_freq;
-
-        _scheduler.reset(timestep, _scheduler.sync(), _scheduler.current_time());
+        // the termination conditions keep being checked at every physics step by default
+        if (_termination_freq == old_physics_freq || _termination_freq > _physics_freq)
+            _termination_freq = _physics_freq;
+
+        // the periods of the tasks are recomputed by reset(): the frequencies have to be valid for
+        // the time-step used when they are set (i.e., lower frequencies first, higher frequencies last)
+        if (smaller)
+            _scheduler.reset(timestep, _scheduler.sync(), _scheduler.current_time());
+        _scheduler.set_task_frequency(_physics_task, _physics_freq);
+        _scheduler.set_task_frequency(_control_task, _control_freq);
+        _scheduler.set_task_frequency(_termination_task, _termination_freq);
+        if (!smaller)
+            _scheduler.reset(timestep, _scheduler.sync(), _scheduler.current_time());
     }
 
     void RobotDARTSimu::stop_sim(bool disable)
     {
         _break = disable;
+        if (!disable)
+            _terminated_by = -1;
     }
 
     bool RobotDARTSimu::halted_sim() const
@@ -241,6 +492,127 @@ namespace robot_dart {
         return _break;
     }
 
+    void RobotDARTSimu::add_termination_condition(const TerminationCondition& condition)
+    {
+        _termination_conditions.push_back(condition);
+    }
+
+    const std::vector<TerminationCondition>& RobotDARTSimu::termination_conditions() const
+    {
+        return _termination_conditions;
+    }
+
+    void RobotDARTSimu::clear_termination_conditions()
+    {
+        _termination_conditions.clear();
+    }
+
+    SimuState RobotDARTSimu::save_state() const
+    {
+        SimuState state;
+        save_state(state);
+        return state;
+    }
+
+    void RobotDARTSimu::save_state(SimuState& state) const
+    {
+        // header: world time, scheduler counters, descriptors' counter and break flag
+        constexpr size_t header_size = 6;
+
+        size_t total_size = header_size;
+        state.layout.resize(2 * _robots.size());
+        for (size_t r = 0; r < _robots.size(); r++) {
+            size_t ctrl_size = 0;
+            for (size_t c = 0; c < _robots[r]->num_controllers(); c++)
+                ctrl_size += _robots[r]->controller(c)->state_size();
+            state.layout[2 * r] = _robots[r]->num_dofs();
+            state.layout[2 * r + 1] = ctrl_size;
+            total_size += 3 * state.layout[2 * r] + ctrl_size;
+        }
+        state.data.resize(total_size);
+
+        double* data = state.data.data();
+        data[0] = _world->getTime();
+        data[1] = _scheduler.current_step();
+        data[2] = _scheduler.current_time() - _scheduler.simu_start_time();
+        data[3] = _scheduler.simu_start_time();
+        data[4] = _old_index;
+        data[5] = _break;
+        data += header_size;
+
+        for (auto& robot : _robots) {
+            auto skel = robot->skeleton();
+            size_t dofs = skel->getNumDofs();
+            for (size_t i = 0; i < dofs; i++) {
+                auto dof = skel->getDof(i);
+                data[i] = dof->getPosition();
+                data[dofs + i] = dof->getVelocity();
+                data[2 * dofs + i] = dof->getCommand();
+            }
+            data += 3 * dofs;
+
+            for (size_t c = 0; c < robot->num_controllers(); c++) {
+                auto ctrl = robot->controller(c);
+                ctrl->save_state(data);
+                data += ctrl->state_size();
+            }
+        }
+    }
+
+    bool RobotDARTSimu::restore_state(const SimuState& state, bool restore_controllers)
+    {
+        constexpr size_t header_size = 6;
+
+        ROBOT_DART_ASSERT(state.layout.size() == 2 * _robots.size(), "restore_state: the number of robots is not the same as in the saved state", false);
+        size_t data_size = header_size;
+        for (size_t r = 0; r < _robots.size(); r++) {
+            ROBOT_DART_ASSERT(state.layout[2 * r] == _robots[r]->num_dofs(), "restore_state: robot " + _robots[r]->name() + " does not match the saved state", false);
+            if (restore_controllers) {
+                size_t ctrl_size = 0;
+                for (size_t c = 0; c < _robots[r]->num_controllers(); c++)
+                    ctrl_size += _robots[r]->controller(c)->state_size();
+                ROBOT_DART_ASSERT(state.layout[2 * r + 1] == ctrl_size, "restore_state: the controllers of robot " + _robots[r]->name() + " do not match the saved state", false);
+            }
+            data_size += 3 * state.layout[2 * r] + state.layout[2 * r + 1];
+        }
+        // the data can be modified independently of the layout (e.g., from python)
+        ROBOT_DART_ASSERT(state.data.size() == data_size, "restore_state: the size of the data does not match the layout of the saved state", false);
+
+        const double* data = state.data.data();
+        _world->setTime(data[0]);
+        _scheduler.set_state(static_cast<int>(data[1]), data[2], data[3]);
+        _old_index = static_cast<size_t>(data[4]);
+        _break = data[5] != 0.;
+        _terminated_by = -1;
+        data += header_size;
+        // the sleeping robots are not part of the state
+        wake_up_all();
+
+        for (size_t r = 0; r < _robots.size(); r++) {
+            auto skel = _robots[r]->skeleton();
+            size_t dofs = skel->getNumDofs();
+            for (size_t i = 0; i < dofs; i++) {
+                auto dof = skel->getDof(i);
+                dof->setPosition(data[i]);
+                dof->setVelocity(data[dofs + i]);
+                dof->setCommand(data[2 * dofs + i]);
+            }
+            data += 3 * dofs;
+
+            if (!restore_controllers) {
+                data += state.layout[2 * r + 1];
+                continue;
+            }
+            for (size_t c = 0; c < _robots[r]->num_controllers(); c++) {
+                auto ctrl = _robots[r]->controller(c);
+                ctrl->restore_state(data);
+                data += ctrl->state_size();
+            }
+        }
+
+        return true;
+    }
+
     size_t RobotDARTSimu::num_robots() const
     {
         return _robots.size();
@@ -267,8 +639,11 @@ namespace robot_dart {
     void RobotDARTSimu::add_robot(const std::shared_ptr<Robot>& robot)
     {
         if (robot->skeleton()) {
+            _graphics->finish();
             _robots.push_back(robot);
             _world->addSkeleton(robot->skeleton());
+            std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter)->add_skeleton(robot->skeleton());
+            _collision_groups_dirty = true;
 
             _gui_data->update_robot(robot);
         }
@@ -296,6 +671,7 @@ namespace robot_dart {
             // set the ghost/visual flag
             robot->set_ghost(true);
 
+            _graphics->finish();
             _robots.push_back(robot);
             _world->addSkeleton(robot->skeleton());
 
@@ -307,8 +683,13 @@ namespace robot_dart {
     {
         auto it = std::find(_robots.begin(), _robots.end(), robot);
         if (it != _robots.end()) {
+            _graphics->finish();
+            wake_up(std::distance(_robots.begin(), it));
+            _sleep_states.erase(robot->skeleton().get());
             _world->removeSkeleton(robot->skeleton());
+            std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter)->remove_skeleton(robot->skeleton());
             _robots.erase(it);
+            _collision_groups_dirty = true;
 
             _gui_data->remove_robot(robot);
         }
@@ -317,16 +698,29 @@ namespace robot_dart {
     void RobotDARTSimu::remove_robot(size_t index)
     {
         ROBOT_DART_ASSERT(index < _robots.size(), "Robot index out of bounds", );
+        _graphics->finish();
+        wake_up(index);
+        _sleep_states.erase(_robots[index]->skeleton().get());
         _world->removeSkeleton(_robots[index]->skeleton());
+        std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter)->remove_skeleton(_robots[index]->skeleton());
+        _gui_data->remove_robot(_robots[index]);
         _robots.erase(_robots.begin() + index);
+        _collision_groups_dirty = true;
     }
 
     void RobotDARTSimu::clear_robots()
     {
+        _graphics->finish();
+        wake_up_all();
+        _sleep_states.clear();
+        auto coll_filter = std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter);
         for (auto& robot : _robots) {
             _world->removeSkeleton(robot->skeleton());
+            coll_filter->remove_skeleton(robot->skeleton());
+            _gui_data->remove_robot(robot);
         }
         _robots.clear();
+        _collision_groups_dirty = true;
     }
 
     void RobotDARTSimu::remove_descriptor(const std::shared_ptr<descriptor::BaseDescriptor>& desc)
@@ -465,32 +859,94 @@ namespace robot_dart {
             c = tolower(c);
 
         if (coll == "dart")
-            _world->getConstraintSolver()->setCollisionDetector(dart::collision::DARTCollisionDetector::create());
+            _world->getConstraintSolver()->setCollisionDetector(collision_filter::GroupedCollisionDetector<dart::collision::DARTCollisionDetector>::create());
         else if (coll == "fcl")
-            _world->getConstraintSolver()->setCollisionDetector(dart::collision::FCLCollisionDetector::create());
+            _world->getConstraintSolver()->setCollisionDetector(collision_filter::GroupedCollisionDetector<dart::collision::FCLCollisionDetector>::create());
         else if (coll == "bullet") {
 #if (HAVE_BULLET == 1)
-            _world->getConstraintSolver()->setCollisionDetector(dart::collision::BulletCollisionDetector::create());
+            _world->getConstraintSolver()->setCollisionDetector(collision_filter::GroupedCollisionDetector<dart::collision::BulletCollisionDetector>::create());
 #else
             ROBOT_DART_WARNING(true, "DART is not installed with Bullet! Cannot set BulletCollisionDetector!");
 #endif
         }
         else if (coll == "ode") {
 #if (HAVE_ODE == 1)
-            _world->getConstraintSolver()->setCollisionDetector(dart::collision::OdeCollisionDetector::create());
+            _world->getConstraintSolver()->setCollisionDetector(collision_filter::GroupedCollisionDetector<dart::collision::OdeCollisionDetector>::create());
 #else
             ROBOT_DART_WARNING(true, "DART is not installed with ODE! Cannot set OdeCollisionDetector!");
 #endif
         }
+        // the groups belong to the previous detector
+        _collision_groups_dirty = true;
     }
 
     const std::string& RobotDARTSimu::collision_detector() const { return _world->getConstraintSolver()->getCollisionDetector()->getType(); }
 
+    std::vector<CollisionDetectorProbe> RobotDARTSimu::probe_collision_detectors(double duration, double tolerance, bool apply)
+    {
+        std::vector<std::string> detectors = {"dart", "fcl"};
+#if (HAVE_BULLET == 1)
+        detectors.push_back("bullet");
+#endif
+#if (HAVE_ODE == 1)
+        detectors.push_back("ode");
+#endif
+
+        size_t num_steps = std::max(1, static_cast<int>(std::round(duration / _world->getTimeStep())));
+        auto solver = _world->getConstraintSolver();
+        auto original = solver->getCollisionDetector();
+        SimuState state = save_state();
+        _graphics->finish();
+
+        // the current detector is the reference
+        std::vector<CollisionDetectorProbe> probes;
+        probes.push_back(_probe_collision_detector(num_steps));
+        std::vector<Eigen::VectorXd> positions;
+        probes[0].consistent = true;
+        for (auto& robot : _robots) {
+            positions.push_back(robot->positions());
+            probes[0].consistent = probes[0].consistent && positions.back().allFinite();
+        }
+
+        for (auto& detector : detectors) {
+            if (detector == probes[0].detector)
+                continue;
+            restore_state(state);
+            set_collision_detector(detector);
+
+            CollisionDetectorProbe probe = _probe_collision_detector(num_steps);
+            bool finite = true;
+            for (size_t r = 0; r < _robots.size(); r++) {
+                Eigen::VectorXd q = _robots[r]->positions();
+                finite = finite && q.allFinite();
+                if (q.size() > 0)
+                    probe.position_error = std::max(probe.position_error, (q - positions[r]).cwiseAbs().maxCoeff());
+            }
+            probe.consistent = finite && ((probe.num_contacts > 0.) == (probes[0].num_contacts > 0.)) && probe.position_error <= tolerance;
+            probes.push_back(probe);
+        }
+
+        restore_state(state);
+        size_t best = 0;
+        for (size_t i = 1; i < probes.size(); i++)
+            if (probes[i].consistent && (!probes[best].consistent || probes[i].step_time < probes[best].step_time))
+                best = i;
+
+        if (apply && best != 0)
+            set_collision_detector(probes[best].detector);
+        else
+            solver->setCollisionDetector(original);
+        _collision_groups_dirty = true;
+
+        return probes;
+    }
+
     void RobotDARTSimu::set_collision_mask(size_t robot_index, uint16_t mask)
     {
         ROBOT_DART_ASSERT(robot_index < _robots.size(), "Robot index out of bounds", );
         auto coll_filter = std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter);
         coll_filter->add_to_map(_robots[robot_index]->skeleton(), mask);
+        _collision_groups_dirty = true;
     }
 
     void RobotDARTSimu::set_collision_mask(size_t robot_index, const std::string& body_name, uint16_t mask)
@@ -501,6 +957,7 @@ namespace robot_dart {
         auto coll_filter = std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter);
         for (auto& shape : bd->getShapeNodes())
             coll_filter->add_to_map(shape, mask);
+        _collision_groups_dirty = true;
     }
 
     void RobotDARTSimu::set_collision_mask(size_t robot_index, size_t body_index, uint16_t mask)
@@ -512,6 +969,7 @@ namespace robot_dart {
         auto coll_filter = std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter);
         for (auto& shape : bd->getShapeNodes())
             coll_filter->add_to_map(shape, mask);
+        _collision_groups_dirty = true;
     }
 
     uint16_t RobotDARTSimu::collision_mask(size_t robot_index, const std::string& body_name)
@@ -548,6 +1006,7 @@ namespace robot_dart {
         ROBOT_DART_ASSERT(robot_index < _robots.size(), "Robot index out of bounds", );
         auto coll_filter = std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter);
         coll_filter->remove_from_map(_robots[robot_index]->skeleton());
+        _collision_groups_dirty = true;
     }
 
     void RobotDARTSimu::remove_collision_mask(size_t robot_index, const std::string& body_name)
@@ -558,6 +1017,7 @@ namespace robot_dart {
         auto coll_filter = std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter);
         for (auto& shape : bd->getShapeNodes())
             coll_filter->remove_from_map(shape);
+        _collision_groups_dirty = true;
     }
 
     void RobotDARTSimu::remove_collision_mask(size_t robot_index, size_t body_index)
@@ -569,11 +1029,292 @@ namespace robot_dart {
         auto coll_filter = std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter);
         for (auto& shape : bd->getShapeNodes())
             coll_filter->remove_from_map(shape);
+        _collision_groups_dirty = true;
     }
 
     void RobotDARTSimu::remove_all_collision_masks()
     {
         auto coll_filter = std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter);
         coll_filter->clear_all();
+        _collision_groups_dirty = true;
+    }
+
+    void RobotDARTSimu::enable_collision_groups(bool enable)
+    {
+        _collision_groups = enable;
+        _update_collision_groups();
+    }
+
+    size_t RobotDARTSimu::num_collision_groups()
+    {
+        if (_collision_groups && (_collision_groups_dirty || _world->getNumSkeletons() != _num_grouped_skeletons))
+            _update_collision_groups();
+        return _num_collision_groups;
+    }
+
+    void RobotDARTSimu::enable_sleeping(bool enable, double velocity_threshold, double time_to_sleep)
+    {
+        ROBOT_DART_EXCEPTION_ASSERT(velocity_threshold >= 0. && time_to_sleep >= 0., "enable_sleeping: the velocity threshold and the time to sleep cannot be negative");
+        if (!enable)
+            wake_up_all();
+        _sleeping = enable;
+        _sleep_velocity = velocity_threshold;
+        _sleep_time = time_to_sleep;
+        std::static_pointer_cast<collision_filter::BitmaskContactFilter>(_world->getConstraintSolver()->getCollisionOption().collisionFilter)->set_skip_static_pairs(enable);
+    }
+
+    bool RobotDARTSimu::sleeping(size_t robot_index) const
+    {
+        ROBOT_DART_ASSERT(robot_index < _robots.size(), "Robot index out of bounds", false);
+        auto it = _sleep_states.find(_robots[robot_index]->skeleton().get());
+        return it != _sleep_states.end() && it->second.island >= 0;
+    }
+
+    size_t RobotDARTSimu::num_sleeping() const
+    {
+        size_t num = 0;
+        for (auto& state : _sleep_states)
+            if (state.second.island >= 0)
+                num++;
+        return num;
+    }
+
+    void RobotDARTSimu::wake_up(size_t robot_index)
+    {
+        ROBOT_DART_ASSERT(robot_index < _robots.size(), "Robot index out of bounds", );
+        auto it = _sleep_states.find(_robots[robot_index]->skeleton().get());
+        if (it != _sleep_states.end())
+            _wake_up_island(it->second.island);
+    }
+
+    void RobotDARTSimu::wake_up_all()
+    {
+        for (auto& robot : _robots) {
+            auto it = _sleep_states.find(robot->skeleton().get());
+            if (it == _sleep_states.end())
+                continue;
+            if (it->second.island >= 0)
+                robot->skeleton()->setMobile(true);
+            it->second.island = -1;
+            it->second.rest_time = 0.;
+        }
+    }
+
+    void RobotDARTSimu::_update_collision_groups()
+    {
+        _collision_groups_dirty = false;
+        _num_grouped_skeletons = _world->getNumSkeletons();
+        _num_collision_groups = 0;
+
+        auto solver = _world->getConstraintSolver();
+        auto detector = solver->getCollisionDetector();
+        // nullptr if the detector was replaced through world()
+        auto grouped = dynamic_cast<collision_filter::CollisionGroups*>(detector.get());
+        ROBOT_DART_WARNING(_collision_groups && !grouped, "The collision detector does not support collision groups! Use set_collision_detector() to change it!");
+        if (!grouped)
+            return;
+        grouped->clear_groups();
+        if (!_collision_groups)
+            return;
+
+        // one group per combination of masks (OR of the masks of the collision shapes of the skeleton)
+        auto coll_filter = std::static_pointer_cast<collision_filter::BitmaskContactFilter>(solver->getCollisionOption().collisionFilter);
+        std::vector<uint32_t> masks;
+        std::vector<std::shared_ptr<dart::collision::CollisionGroup>> groups;
+        for (size_t i = 0; i < _world->getNumSkeletons(); i++) {
+            auto skel = _world->getSkeleton(i);
+            uint32_t mask = 0;
+            bool collidable = false;
+            for (size_t s = 0; s < skel->getNumShapeNodes(); s++) {
+                auto shape = skel->getShapeNode(s);
+                if (!shape->has<dart::dynamics::CollisionAspect>())
+                    continue;
+                collidable = true;
+                mask |= coll_filter->raw_mask(shape);
+            }
+            // e.g., visual robots
+            if (!collidable)
+                continue;
+
+            size_t g = std::distance(masks.begin(), std::find(masks.begin(), masks.end(), mask));
+            if (g == masks.size()) {
+                masks.push_back(mask);
+                groups.push_back(detector->createCollisionGroupAsSharedPtr());
+            }
+            groups[g]->subscribeTo(skel);
+        }
+
+        // the pairs of groups (and the groups with themselves) that can interact; the filter still runs on their shapes
+        std::vector<std::pair<size_t, size_t>> pairs;
+        for (size_t i = 0; i < groups.size(); i++)
+            for (size_t j = i; j < groups.size(); j++)
+                if (collision_filter::BitmaskContactFilter::interact(masks[i], masks[j]))
+                    pairs.push_back(std::make_pair(i, j));
+
+        grouped->set_groups(solver->getCollisionGroup().get(), groups, pairs);
+        _num_collision_groups = groups.size();
+    }
+
+    CollisionDetectorProbe RobotDARTSimu::_probe_collision_detector(size_t num_steps)
+    {
+        if (_collision_groups)
+            _update_collision_groups();
+
+        CollisionDetectorProbe probe;
+        probe.detector = collision_detector();
+        for (size_t k = 0; k < num_steps; k++) {
+            if (_scheduler.runs(_control_task))
+                for (auto& robot : _robots)
+                    robot->update(_world->getTime());
+
+            // only the physics step is timed
+            auto start = std::chrono::steady_clock::now();
+            _world->step(false);
+            probe.step_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            probe.num_contacts += _world->getLastCollisionResult().getNumContacts();
+
+            _scheduler.step();
+        }
+        probe.step_time /= num_steps;
+        probe.num_contacts /= num_steps;
+
+        return probe;
+    }
+
+    void RobotDARTSimu::_wake_up_robots()
+    {
+        for (auto& robot : _robots) {
+            auto skel = robot->skeleton();
+            auto it = _sleep_states.find(skel.get());
+            if (it == _sleep_states.end() || it->second.island < 0)
+                continue;
+
+            // the velocities of the sleeping robots are set to zero: any change comes from the user
+            bool wake_up = false;
+            for (size_t i = 0; i < skel->getNumDofs() && !wake_up; i++)
+                wake_up = skel->getDof(i)->getVelocity() != 0. || skel->getDof(i)->getCommand() != 0.;
+            for (size_t i = 0; i < skel->getNumBodyNodes() && !wake_up; i++)
+                wake_up = !skel->getBodyNode(i)->getExternalForceLocal().isZero();
+
+            if (wake_up)
+                _wake_up_island(it->second.island);
+        }
+    }
+
+    void RobotDARTSimu::_wake_up_island(int island)
+    {
+        if (island < 0)
+            return;
+        for (auto& robot : _robots) {
+            auto it = _sleep_states.find(robot->skeleton().get());
+            if (it == _sleep_states.end() || it->second.island != island)
+                continue;
+            robot->skeleton()->setMobile(true);
+            it->second.island = -1;
+            it->second.rest_time = 0.;
+        }
+    }
+
+    void RobotDARTSimu::_update_sleeping()
+    {
+        auto skeleton = [](const dart::collision::CollisionObject* object) -> const dart::dynamics::Skeleton* {
+            auto shape_node = object->getShapeFrame()->asShapeNode();
+            return shape_node ? shape_node->getSkeleton().get() : nullptr;
+        };
+        auto movable = [](const dart::dynamics::Skeleton* skel) { return skel && skel->isMobile() && skel->getNumDofs() > 0; };
+        auto state = [this](const dart::dynamics::Skeleton* skel) -> SleepState* {
+            auto it = _sleep_states.find(skel);
+            return it == _sleep_states.end() ? nullptr : &it->second;
+        };
+
+        const auto& result = _world->getLastCollisionResult();
+        // the sleeping islands touched by a skeleton that can move wake up
+        for (size_t i = 0; i < result.getNumContacts(); i++) {
+            const auto& contact = result.getContact(i);
+            auto skel1 = skeleton(contact.collisionObject1);
+            auto skel2 = skeleton(contact.collisionObject2);
+            SleepState* state1 = state(skel1);
+            SleepState* state2 = state(skel2);
+            if (state1 && state1->island >= 0 && movable(skel2))
+                _wake_up_island(state1->island);
+            if (state2 && state2->island >= 0 && movable(skel1))
+                _wake_up_island(state2->island);
+        }
+
+        // time spent at rest by the robots that can fall asleep
+        size_t num_robots = _robots.size();
+        // buffers kept between the steps (no allocation once the number of robots is stable)
+        auto& states = _sleep_candidates;
+        auto& parents = _island_parents;
+        states.assign(num_robots, nullptr);
+        parents.resize(num_robots);
+        double dt = _world->getTimeStep();
+        for (size_t r = 0; r < num_robots; r++) {
+            parents[r] = r;
+            auto skel = _robots[r]->skeleton();
+            SleepState& s = _sleep_states[skel.get()];
+            s.index = r;
+            if (s.island >= 0)
+                continue;
+            if (_robots[r]->ghost() || _robots[r]->num_controllers() > 0 || !movable(skel.get())) {
+                s.rest_time = 0.;
+                continue;
+            }
+
+            bool rest = true;
+            for (size_t i = 0; i < skel->getNumDofs() && rest; i++)
+                rest = std::abs(skel->getDof(i)->getVelocity()) < _sleep_velocity;
+            s.rest_time = rest ? s.rest_time + dt : 0.;
+            states[r] = &s;
+        }
+
+        // islands: the robots in contact with each other (union-find); a robot touching a skeleton that can move but cannot
+        // fall asleep (e.g., a controlled robot) has to stay awake
+        auto root = [&parents](size_t r) -> size_t {
+            while (parents[r] != r)
+                r = parents[r] = parents[parents[r]];
+            return r;
+        };
+        for (size_t i = 0; i < result.getNumContacts(); i++) {
+            const auto& contact = result.getContact(i);
+            auto skel1 = skeleton(contact.collisionObject1);
+            auto skel2 = skeleton(contact.collisionObject2);
+            if (!movable(skel1) || !movable(skel2))
+                continue;
+            SleepState* state1 = state(skel1);
+            SleepState* state2 = state(skel2);
+            bool candidate1 = state1 && states[state1->index];
+            bool candidate2 = state2 && states[state2->index];
+            if (candidate1 && candidate2)
+                parents[root(state1->index)] = root(state2->index);
+            else if (candidate1)
+                state1->rest_time = 0.;
+            else if (candidate2)
+                state2->rest_time = 0.;
+        }
+
+        // an island falls asleep when all its robots have been at rest long enough
+        auto& island_rest_times = _island_rest_times;
+        island_rest_times.assign(num_robots, std::numeric_limits<double>::max());
+        for (size_t r = 0; r < num_robots; r++)
+            if (states[r])
+                island_rest_times[root(r)] = std::min(island_rest_times[root(r)], states[r]->rest_time);
+
+        auto& islands = _island_ids;
+        islands.assign(num_robots, -1);
+        for (size_t r = 0; r < num_robots; r++) {
+            size_t i = root(r);
+            if (!states[r] || island_rest_times[i] < _sleep_time)
+                continue;
+            if (islands[i] < 0)
+                islands[i] = _num_islands++;
+
+            auto skel = _robots[r]->skeleton();
+            skel->setMobile(false);
+            skel->resetVelocities();
+            skel->resetAccelerations();
+            states[r]->island = islands[i];
+            states[r]->rest_time = 0.;
+        }
     }
 } // namespace robot_dart
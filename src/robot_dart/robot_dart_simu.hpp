@@ -5,14 +5,38 @@
 
 #include <robot_dart/descriptor/base_descriptor.hpp>
 #include <robot_dart/gui/base.hpp>
+#include <robot_dart/profiler.hpp>
 #include <robot_dart/robot.hpp>
 #include <robot_dart/scheduler.hpp>
+#include <robot_dart/termination.hpp>
+
+#include <unordered_map>
 
 namespace robot_dart {
     namespace simu {
         struct GUIData;
     }
 
+    class Recorder;
+
+    // Flat snapshot of a simulation; see RobotDARTSimu::save_state()
+    struct SimuState {
+        std::vector<double> data;
+        // number of DoFs and size of the controllers' state of each robot (used for validation)
+        std::vector<size_t> layout;
+    };
+
+    // Result of RobotDARTSimu::probe_collision_detectors() for one collision detector
+    struct CollisionDetectorProbe {
+        std::string detector;
+        // mean wall-clock time of a physics step (in seconds) and mean number of contacts per step
+        double step_time = 0., num_contacts = 0.;
+        // largest difference between the positions of the robots at the end of the probe and the ones obtained with the current detector
+        double position_error = 0.;
+        // finite state, contacts found if and only if the current detector finds some, and position_error <= tolerance
+        bool consistent = false;
+    };
+
     class RobotDARTSimu {
     public:
         using robot_t = std::shared_ptr<Robot>;
@@ -29,6 +53,14 @@ namespace robot_dart {
         const Scheduler& scheduler() const { return _scheduler; }
         bool schedule(int freq) { return _scheduler(freq); }
 
+        // per-phase timings of step()/step_world() (only filled when compiled with ROBOT_DART_ENABLE_PROFILING)
+        StepProfiler& profiler() { return _profiler; }
+        const StepProfiler& profiler() const { return _profiler; }
+
+        // stream the commands of every control tick to a log (see Recorder); nullptr stops recording
+        void set_recorder(const std::shared_ptr<Recorder>& recorder) { _recorder = recorder; }
+        std::shared_ptr<Recorder> recorder() const { return _recorder; }
+
         int physics_freq() const { return _physics_freq; }
         int control_freq() const { return _control_freq; }
 
@@ -37,6 +69,7 @@ namespace robot_dart {
             ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(
                 frequency <= _physics_freq && "Control frequency needs to be less than physics frequency");
             _control_freq = frequency;
+            _scheduler.set_task_frequency(_control_task, frequency);
         }
 
         int graphics_freq() const { return _graphics_freq; }
@@ -46,6 +79,7 @@ namespace robot_dart {
             ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(
                 frequency <= _physics_freq && "Graphics frequency needs to be less than physics frequency");
             _graphics_freq = frequency;
+            _scheduler.set_task_frequency(_graphics_task, frequency);
         }
 
         std::shared_ptr<gui::Base> graphics() const;
@@ -81,6 +115,35 @@ namespace robot_dart {
         void stop_sim(bool disable = true);
         bool halted_sim() const;
 
+        // early termination: the simulation is halted (see stop_sim) as soon as one of the conditions is violated
+        // the conditions are checked after the physics step, at termination_freq() (physics frequency by default)
+        void add_termination_condition(const TerminationCondition& condition);
+        const std::vector<TerminationCondition>& termination_conditions() const;
+        void clear_termination_conditions();
+
+        int termination_freq() const { return _termination_freq; }
+        void set_termination_freq(int frequency)
+        {
+            ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(
+                frequency <= _physics_freq && "Termination frequency needs to be less than physics frequency");
+            _termination_freq = frequency;
+            _scheduler.set_task_frequency(_termination_task, frequency);
+        }
+
+        // index of the condition that halted the simulation (-1 if none); cleared by run(), stop_sim(false) and restore_state()
+        int terminated_by() const { return _terminated_by; }
+        bool terminated() const { return _terminated_by >= 0; }
+
+        // Snapshot of the world time, scheduler counters and, for every robot, positions, velocities,
+        // commands and controllers' internal state in one contiguous buffer.
+        // Robots, controllers and descriptors are not copied: restoring is only valid for the same setup.
+        SimuState save_state() const;
+        // re-uses the buffer of state (no allocation if the setup did not change)
+        void save_state(SimuState& state) const;
+        // restore_controllers == false: only the world and the robots are restored (the state of the controllers is skipped,
+        // they do not have to match); returns false (nothing is restored) if the state does not match the simulation
+        bool restore_state(const SimuState& state, bool restore_controllers = true);
+
         size_t num_robots() const;
         const std::vector<robot_t>& robots() const;
         robot_t robot(size_t index) const;
@@ -99,6 +162,10 @@ namespace robot_dart {
 
         void set_collision_detector(const std::string& collision_detector); // collision_detector can be "DART", "FCL", "Ode" or "Bullet" (case does not matter)
         const std::string& collision_detector() const;
+        // Runs the next `duration` seconds of the scene with every available collision detector ("dart", "fcl" and, when DART has them, "bullet" and "ode"),
+        // each time from the current state (restored afterwards; the graphics and the descriptors are not updated).
+        // The current detector is probed first and is the reference. If apply is true, the fastest consistent detector is kept.
+        std::vector<CollisionDetectorProbe> probe_collision_detectors(double duration = 0.1, double tolerance = 1e-2, bool apply = true);
 
         // Bitmask collision filtering
         void set_collision_mask(size_t robot_index, uint16_t mask);
@@ -114,7 +181,41 @@ namespace robot_dart {
 
         void remove_all_collision_masks();
 
+        // Broadphase pre-culling: the skeletons of the world are put in one DART collision group per combination of masks
+        // and only the groups whose masks can interact are checked against each other (e.g., robots that only collide with the floor
+        // are never tested against each other). The groups are rebuilt before the next step when robots or masks change.
+        void enable_collision_groups(bool enable = true);
+        bool collision_groups_enabled() const { return _collision_groups; }
+        size_t num_collision_groups();
+
+        // Sleeping of resting robots: the robots without controllers whose velocities stay below velocity_threshold (for every DoF)
+        // during time_to_sleep seconds are made immobile (they are not integrated and their contacts with the floor or with other
+        // immobile skeletons are skipped). Robots that touch each other fall asleep together (island). A sleeping island wakes up
+        // when a skeleton that can move touches it, or when one of its robots is given an external force, a command or a velocity.
+        // While sleeping is enabled, the contacts between two skeletons that cannot move (sleeping or immobile robots, floor) are
+        // not computed: they are not in world()->getLastCollisionResult(), so contact readouts (e.g., descriptor::SensorBuffer)
+        // report no contact and no supporting force for a sleeping robot on the floor (wake it up and step once to read them).
+        void enable_sleeping(bool enable = true, double velocity_threshold = 1e-2, double time_to_sleep = 0.5);
+        bool sleeping_enabled() const { return _sleeping; }
+        bool sleeping(size_t robot_index) const;
+        size_t num_sleeping() const;
+        void wake_up(size_t robot_index);
+        void wake_up_all();
+
     protected:
+        // time spent below the velocity threshold, island (-1 if awake) and index of the robot (updated at every step)
+        struct SleepState {
+            double rest_time = 0.;
+            int island = -1;
+            size_t index = 0;
+        };
+
+        void _update_collision_groups();
+        void _wake_up_robots();
+        void _wake_up_island(int island);
+        void _update_sleeping();
+        CollisionDetectorProbe _probe_collision_detector(size_t num_steps);
+
         dart::simulation::WorldPtr _world;
         size_t _old_index;
         bool _break;
@@ -125,7 +226,24 @@ namespace robot_dart {
         std::shared_ptr<gui::Base> _graphics;
         std::unique_ptr<simu::GUIData> _gui_data;
         Scheduler _scheduler;
-        int _physics_freq = -1, _control_freq = -1, _graphics_freq = 40;
+        StepProfiler _profiler;
+        std::shared_ptr<Recorder> _recorder;
+        int _physics_freq = -1, _control_freq = -1, _graphics_freq = 40, _termination_freq = -1;
+        // ids of the corresponding tasks in the scheduler
+        int _physics_task = -1, _control_task = -1, _graphics_task = -1, _termination_task = -1;
+        std::vector<TerminationCondition> _termination_conditions;
+        int _terminated_by = -1;
+        bool _collision_groups = false, _collision_groups_dirty = true;
+        size_t _num_grouped_skeletons = 0, _num_collision_groups = 0;
+        bool _sleeping = false;
+        double _sleep_velocity = 1e-2, _sleep_time = 0.5;
+        int _num_islands = 0;
+        std::unordered_map<const dart::dynamics::Skeleton*, SleepState> _sleep_states;
+        // buffers of _update_sleeping(), indexed by robot (robots that can fall asleep, union-find of the islands)
+        std::vector<SleepState*> _sleep_candidates;
+        std::vector<size_t> _island_parents;
+        std::vector<double> _island_rest_times;
+        std::vector<int> _island_ids;
     };
 } // namespace robot_dart
 
@@ -0,0 +1,62 @@
+#include "robot_prototype.hpp"
+#include "utils.hpp"
+
+#include <robot_dart/control/robot_control.hpp>
+
+namespace robot_dart {
+    RobotPrototype::RobotPrototype(const std::shared_ptr<Robot>& robot)
+    {
+        ROBOT_DART_EXCEPTION_ASSERT(robot, "RobotPrototype: no robot given");
+
+        // same as Robot::clone(): the robot might be in use
+        auto skel = robot->skeleton();
+        skel->getMutex().lock();
+#if DART_VERSION_AT_LEAST(6, 7, 2)
+        _skeleton = skel->cloneSkeleton();
+#else
+        _skeleton = skel->clone();
+#endif
+        skel->getMutex().unlock();
+        // update the kinematics once: cloning only reads the prototype afterwards
+        _skeleton->computeForwardKinematics();
+
+        _name = robot->name();
+        _damages = robot->damages();
+        for (size_t i = 0; i < robot->num_controllers(); i++) {
+            auto ctrl = robot->controller(i);
+            _controllers.push_back({ctrl->clone(), ctrl->weight()});
+        }
+    }
+
+    std::shared_ptr<Robot> RobotPrototype::clone(const std::string& name) const
+    {
+        // the clone attaches new ShapeFrames to the (shared) shapes of the prototype, whose signals are not thread-safe:
+        // only the cloning of the skeleton is serialized, the controllers and the robot are built in parallel
+        _skeleton->getMutex().lock();
+#if DART_VERSION_AT_LEAST(6, 7, 2)
+        auto tmp_skel = _skeleton->cloneSkeleton();
+#else
+        auto tmp_skel = _skeleton->clone();
+#endif
+        _skeleton->getMutex().unlock();
+        auto robot = std::make_shared<Robot>(tmp_skel, name.empty() ? _name : name);
+        // the damages are already applied to the skeleton
+        robot->_damages = _damages;
+        for (auto& ctrl : _controllers)
+            robot->add_controller(ctrl.first->clone(), ctrl.second);
+        return robot;
+    }
+
+    std::vector<std::shared_ptr<Robot>> RobotPrototype::clone_n(size_t n, size_t num_threads) const
+    {
+        ThreadPool pool(num_threads);
+        return clone_n(n, pool);
+    }
+
+    std::vector<std::shared_ptr<Robot>> RobotPrototype::clone_n(size_t n, ThreadPool& pool) const
+    {
+        std::vector<std::shared_ptr<Robot>> robots(n);
+        pool.parallel_for(n, [&](size_t i, size_t) { robots[i] = clone(); });
+        return robots;
+    }
+} // namespace robot_dart
@@ -0,0 +1,34 @@
+#ifndef ROBOT_DART_ROBOT_PROTOTYPE_HPP
+#define ROBOT_DART_ROBOT_PROTOTYPE_HPP
+
+#include <robot_dart/robot.hpp>
+#include <robot_dart/thread_pool.hpp>
+
+namespace robot_dart {
+    // Immutable snapshot of a robot (skeleton, damages and controllers) to spawn many copies of it.
+    // Robot::clone() locks the skeleton of the robot while cloning it (the robot might be simulated at the same time);
+    // the skeleton of a prototype is private and never modified, so the clones do not wait for a running simulation.
+    // Like Robot::clone(), the clones share the shapes (and meshes) of the prototype: the cloning of the skeletons is
+    // serialized (it connects to the signals of the shapes), the rest of clone() (controllers, Robot) runs in parallel.
+    class RobotPrototype {
+    public:
+        // later changes of the robot are not seen by the prototype
+        RobotPrototype(const std::shared_ptr<Robot>& robot);
+
+        const std::string& name() const { return _name; }
+
+        // thread-safe; name == "" keeps the name of the robot
+        std::shared_ptr<Robot> clone(const std::string& name = "") const;
+        // n clones built in parallel (num_threads == 0 uses all the available hardware threads)
+        std::vector<std::shared_ptr<Robot>> clone_n(size_t n, size_t num_threads = 0) const;
+        std::vector<std::shared_ptr<Robot>> clone_n(size_t n, ThreadPool& pool) const;
+
+    protected:
+        std::string _name;
+        dart::dynamics::SkeletonPtr _skeleton;
+        std::vector<RobotDamage> _damages;
+        std::vector<std::pair<std::shared_ptr<control::RobotControl>, double>> _controllers;
+    };
+} // namespace robot_dart
+
+#endif
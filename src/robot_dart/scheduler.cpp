@@ -1,21 +1,81 @@
 #include <robot_dart/scheduler.hpp>
 
+#include <algorithm>
+
 namespace robot_dart {
     bool Scheduler::schedule(int frequency)
+    {
+        for (size_t i = 0; i < _tasks.size(); i++)
+            if (_tasks[i].frequency == frequency)
+                return runs(i);
+
+        // not a task: only this frequency is checked against the time-step (like the tasks, at the multiples of its period)
+        _start_sync(frequency);
+        return _current_step % _compute_period(frequency) == 0;
+    }
+
+    bool Scheduler::runs(int task_id)
+    {
+        _start_sync(_task(task_id).frequency);
+        return (_running >> task_id) & 1u;
+    }
+
+    void Scheduler::_start_sync(int frequency)
     {
         if (_max_frequency == -1 && _sync)
-            _start = clock_t::now();
+            _start = clock_t::now() - _duration(_current_time);
 
         _max_frequency = std::max(_max_frequency, frequency);
+    }
+
+    int Scheduler::add_task(int frequency)
+    {
+        ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(_tasks.size() < _max_tasks && "Too many tasks in the scheduler.");
+
+        _tasks.push_back({frequency, _compute_period(frequency), 0});
+        _update_task(_tasks.size() - 1);
+
+        return _tasks.size() - 1;
+    }
+
+    void Scheduler::set_task_frequency(int task_id, int frequency)
+    {
+        ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(task_id >= 0 && task_id < num_tasks() && "Task id out of bounds.");
+
+        _tasks[task_id].frequency = frequency;
+        _tasks[task_id].period = _compute_period(frequency);
+        _update_task(task_id);
+    }
+
+    int Scheduler::_compute_period(int frequency) const
+    {
         double period = std::round((1. / frequency) / _dt);
 
         ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(
             period >= 1. && "Time-step is too big for required frequency.");
 
-        if (_current_step % int(period) == 0)
-            return true;
+        return static_cast<int>(period);
+    }
+
+    void Scheduler::_update_task(int task_id)
+    {
+        auto& task = _tasks[task_id];
+        // the task runs when the step is a multiple of its period
+        task.next_step = ((_current_step + task.period - 1) / task.period) * task.period;
 
-        return false;
+        uint64_t bit = uint64_t(1) << task_id;
+        if (task.next_step == _current_step)
+            _running |= bit;
+        else
+            _running &= ~bit;
+    }
+
+    void Scheduler::_update_tasks()
+    {
+        for (size_t i = 0; i < _tasks.size(); i++) {
+            _tasks[i].period = _compute_period(_tasks[i].frequency);
+            _update_task(i);
+        }
     }
 
     void Scheduler::reset(double dt, bool sync, double current_time)
@@ -29,6 +89,21 @@ namespace robot_dart {
 
         _dt = dt;
         _sync = sync;
+
+        _update_tasks();
+        reset_sync_stats();
+    }
+
+    void Scheduler::set_state(int current_step, double current_time, double simu_start_time)
+    {
+        _current_step = current_step;
+        _current_time = current_time;
+        _simu_start_time = simu_start_time;
+        _update_tasks();
+
+        // re-synchronize with real time from this point
+        if (_sync)
+            _start = clock_t::now() - _duration(_current_time);
     }
 
     void Scheduler::step()
@@ -36,14 +111,66 @@ namespace robot_dart {
         _current_time += _dt;
         _current_step += 1;
 
-        if (_sync) {
-            auto expected = std::chrono::microseconds(int(_current_time * 1e6));
-            auto end = clock_t::now();
-            std::chrono::duration<double, std::micro> real = end - _start;
-            std::chrono::duration<double, std::micro> adjust = expected - real;
-            if (adjust.count() > 0)
-                std::this_thread::sleep_for(adjust);
+        _running = 0;
+        for (size_t i = 0; i < _tasks.size(); i++) {
+            auto& task = _tasks[i];
+            if (task.next_step < _current_step)
+                task.next_step += task.period;
+            if (task.next_step == _current_step)
+                _running |= uint64_t(1) << i;
+        }
+
+        if (_sync)
+            _wait_deadline();
+    }
+
+    void Scheduler::set_spin_margin(double spin_margin)
+    {
+        ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(spin_margin >= 0. && "Spin margin needs to be positive.");
+        _spin_margin = spin_margin;
+    }
+
+    void Scheduler::reset_sync_stats()
+    {
+        set_jitter_histogram(_sync_stats.histogram.size(), _sync_stats.bucket_width);
+    }
+
+    void Scheduler::set_jitter_histogram(size_t num_buckets, double bucket_width)
+    {
+        ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(num_buckets > 0 && bucket_width > 0. && "Invalid jitter histogram.");
+
+        _sync_stats = SyncStats();
+        _sync_stats.bucket_width = bucket_width;
+        _sync_stats.histogram.assign(num_buckets, 0);
+    }
+
+    void Scheduler::_wait_deadline()
+    {
+        auto deadline = _start + _duration(_current_time);
+        auto now = clock_t::now();
+
+        if (now >= deadline)
+            _sync_stats.overruns++;
+        else if (_spin_margin > 0.) {
+            auto wake_up = deadline - _duration(_spin_margin);
+            if (now < wake_up)
+                std::this_thread::sleep_until(wake_up);
+            while (clock_t::now() < deadline) {
+            }
         }
+        else
+            std::this_thread::sleep_until(deadline);
+
+        _sync_stats.add(std::chrono::duration<double, std::micro>(clock_t::now() - deadline).count());
+    }
+
+    void Scheduler::SyncStats::add(double lateness)
+    {
+        steps++;
+        mean_lateness += (lateness - mean_lateness) / steps;
+        max_lateness = std::max(max_lateness, lateness);
+        size_t bucket = std::min(static_cast<size_t>(std::max(lateness, 0.) / bucket_width), histogram.size() - 1);
+        histogram[bucket]++;
     }
 
 } // namespace robot_dart
\ No newline at end of file
@@ -5,22 +5,61 @@
 
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <thread>
+#include <vector>
 
 namespace robot_dart {
     class Scheduler {
     protected:
-        using clock_t = std::chrono::high_resolution_clock;
+        // monotonic: the deadlines are not affected by changes of the system time
+        using clock_t = std::chrono::steady_clock;
 
     public:
+        /// statistics of the real-time synchronization (all times in microseconds)
+        struct SyncStats {
+            size_t steps = 0; // synchronized steps
+            size_t overruns = 0; // steps that were already late before waiting
+            double mean_lateness = 0.;
+            double max_lateness = 0.;
+            // lateness (release time - deadline) histogram:
+            // bucket i counts [i * bucket_width, (i + 1) * bucket_width), the last bucket also counts everything above
+            double bucket_width = 10.;
+            std::vector<size_t> histogram = std::vector<size_t>(100, 0);
+
+            /// record the lateness of a step (in microseconds; negative if released early)
+            void add(double lateness);
+        };
+
         Scheduler(double dt, bool sync = false) : _dt(dt), _sync(sync)
         {
             ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(_dt > 0. && "Time-step needs to be bigger than zero.");
         }
 
         bool operator()(int frequency) { return schedule(frequency); };
+        /// true if a task at this frequency runs at the current step
+        /// (uses the registered task with this frequency if there is one; the frequency is not registered)
         bool schedule(int frequency);
 
+        /// register a task that runs at the given frequency; returns its id
+        /// the periods (in steps) are computed once and the tasks that run at each step are kept in a bitmask
+        int add_task(int frequency);
+        void set_task_frequency(int task_id, int frequency);
+        int num_tasks() const { return static_cast<int>(_tasks.size()); }
+
+        /// bitmask of the tasks that run at the current step (bit i for task i)
+        uint64_t running_tasks() const { return _running; }
+        bool runs(int task_id);
+
+        int task_frequency(int task_id) const { return _task(task_id).frequency; }
+        /// period of a task in steps
+        int task_period(int task_id) const { return _task(task_id).period; }
+        /// frequency at which a task actually runs, i.e., 1 / (period * dt)
+        double task_effective_frequency(int task_id) const { return 1. / (_task(task_id).period * _dt); }
+        /// difference between the effective and the requested frequency of a task
+        /// (non-zero when the period of the task is not a multiple of the time-step)
+        double task_drift(int task_id) const { return task_effective_frequency(task_id) - _task(task_id).frequency; }
+
         /// call this at the end of the loop (see examples)
         /// this will synchronize with real time if requested
         /// and increase the counter
@@ -31,17 +70,65 @@ namespace robot_dart {
         void set_sync(bool enable) { _sync = enable; }
         bool sync() { return _sync; }
 
+        /// real-time mode: sleep until spin_margin seconds before the deadline of the step, then spin
+        /// (trades CPU time for a wake-up jitter that does not depend on the OS timer);
+        /// 0 only sleeps (default)
+        void set_spin_margin(double spin_margin);
+        double spin_margin() const { return _spin_margin; }
+
+        /// cleared by reset()
+        const SyncStats& sync_stats() const { return _sync_stats; }
+        void reset_sync_stats();
+        /// resets the statistics (e.g., set_jitter_histogram(200, 1.) for [0, 200us) in 1us buckets)
+        void set_jitter_histogram(size_t num_buckets, double bucket_width);
+
         double current_time() const { return _simu_start_time + _current_time; }
         double next_time() const { return _simu_start_time + _current_time + _dt; }
         double dt() const { return _dt; }
 
+        int current_step() const { return _current_step; }
+        double simu_start_time() const { return _simu_start_time; }
+
+        /// restore the counters (e.g., from a saved simulation state)
+        /// current_time is relative to simu_start_time (like the counters kept internally)
+        void set_state(int current_step, double current_time, double simu_start_time);
+
     protected:
+        // at most 64 tasks (one bit each)
+        static constexpr int _max_tasks = 64;
+
+        struct Task {
+            int frequency;
+            int period;
+            int next_step; // first step >= current step at which the task runs
+        };
+
+        // seconds -> clock duration (without going through int, which overflows after ~36 minutes in microseconds)
+        static clock_t::duration _duration(double seconds) { return std::chrono::duration_cast<clock_t::duration>(std::chrono::duration<double>(seconds)); }
+
+        const Task& _task(int task_id) const
+        {
+            ROBOT_DART_EXCEPTION_INTERNAL_ASSERT(task_id >= 0 && task_id < num_tasks() && "Task id out of bounds.");
+            return _tasks[task_id];
+        }
+
+        void _start_sync(int frequency);
+        void _wait_deadline();
+        int _compute_period(int frequency) const;
+        void _update_task(int task_id);
+        void _update_tasks();
+
+        std::vector<Task> _tasks;
+        uint64_t _running = 0;
+
         double _current_time = 0., _simu_start_time = 0.;
         double _dt;
         int _current_step = 0;
         bool _sync;
         int _max_frequency = -1;
         clock_t::time_point _start;
+        double _spin_margin = 0.;
+        SyncStats _sync_stats;
     };
 } // namespace robot_dart
 
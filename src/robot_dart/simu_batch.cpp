@@ -0,0 +1,103 @@
+#include "simu_batch.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+
+namespace robot_dart {
+    SimuBatch::SimuBatch(size_t num_worlds, double timestep, size_t num_threads) : _done(num_worlds, 0), _pool(num_threads)
+    {
+        for (size_t i = 0; i < num_worlds; i++)
+            _simus.push_back(std::make_shared<RobotDARTSimu>(timestep));
+    }
+
+    size_t SimuBatch::size() const
+    {
+        return _simus.size();
+    }
+
+    size_t SimuBatch::num_threads() const
+    {
+        return _pool.num_threads();
+    }
+
+    const std::vector<SimuBatch::simu_t>& SimuBatch::simus() const
+    {
+        return _simus;
+    }
+
+    SimuBatch::simu_t SimuBatch::simu(size_t index) const
+    {
+        ROBOT_DART_ASSERT(index < _simus.size(), "Simulation index out of bounds", nullptr);
+        return _simus[index];
+    }
+
+    bool SimuBatch::step(bool reset_commands)
+    {
+        _pool.parallel_for(_simus.size(), [&](size_t i, size_t) {
+            if (_done[i])
+                return;
+            if (_simus[i]->step(reset_commands) || _world_done(i))
+                _done[i] = 1;
+        });
+
+        return all_done();
+    }
+
+    void SimuBatch::run(double max_duration, bool reset_commands)
+    {
+        _pool.parallel_for(_simus.size(), [&](size_t i, size_t) {
+            if (_done[i])
+                return;
+            _simus[i]->run(max_duration, reset_commands);
+            if (_world_done(i))
+                _done[i] = 1;
+        });
+    }
+
+    std::vector<bool> SimuBatch::done() const
+    {
+        return std::vector<bool>(_done.begin(), _done.end());
+    }
+
+    bool SimuBatch::done(size_t index) const
+    {
+        ROBOT_DART_ASSERT(index < _done.size(), "Simulation index out of bounds", true);
+        return _done[index];
+    }
+
+    size_t SimuBatch::num_done() const
+    {
+        return std::count(_done.begin(), _done.end(), 1);
+    }
+
+    bool SimuBatch::all_done() const
+    {
+        return num_done() == _done.size();
+    }
+
+    std::vector<int> SimuBatch::terminated_by() const
+    {
+        std::vector<int> reasons;
+        for (auto& simu : _simus)
+            reasons.push_back(simu->terminated_by());
+        return reasons;
+    }
+
+    void SimuBatch::set_done(size_t index, bool done)
+    {
+        ROBOT_DART_ASSERT(index < _done.size(), "Simulation index out of bounds", );
+        _done[index] = done;
+    }
+
+    void SimuBatch::reset_done()
+    {
+        std::fill(_done.begin(), _done.end(), 0);
+        for (auto& simu : _simus)
+            simu->stop_sim(false);
+    }
+
+    bool SimuBatch::_world_done(size_t index) const
+    {
+        return _simus[index]->halted_sim() || _simus[index]->graphics()->done();
+    }
+} // namespace robot_dart
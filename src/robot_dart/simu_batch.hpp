@@ -0,0 +1,53 @@
+#ifndef ROBOT_DART_SIMU_BATCH_HPP
+#define ROBOT_DART_SIMU_BATCH_HPP
+
+#include <robot_dart/robot_dart_simu.hpp>
+#include <robot_dart/thread_pool.hpp>
+
+namespace robot_dart {
+    // Owns N independent simulations and advances them in lockstep using a fixed-size pool of threads.
+    // The worlds are meant to be headless: GL contexts cannot be shared between threads, so every world
+    // that has graphics/cameras attached needs its own context (see examples/magnum_contexts.cpp).
+    class SimuBatch {
+    public:
+        using simu_t = std::shared_ptr<RobotDARTSimu>;
+
+        // num_threads == 0 uses all the available hardware threads
+        SimuBatch(size_t num_worlds, double timestep = 0.015, size_t num_threads = 0);
+
+        size_t size() const;
+        size_t num_threads() const;
+
+        const std::vector<simu_t>& simus() const;
+        simu_t simu(size_t index) const;
+
+        // advance by one step every world that is not done yet; returns true if all worlds are done
+        bool step(bool reset_commands = false);
+        // run every world that is not done yet for max_duration seconds
+        // worlds do not interact, so each worker runs its worlds to the end without waiting for the others
+        void run(double max_duration = 5.0, bool reset_commands = false);
+
+        // a world is done when it was halted (stop_sim or a termination condition) or its graphics are done
+        // done worlds are not stepped anymore
+        std::vector<bool> done() const;
+        bool done(size_t index) const;
+        size_t num_done() const;
+        bool all_done() const;
+
+        // for every world, index of the termination condition that halted it (-1 if none)
+        std::vector<int> terminated_by() const;
+
+        void set_done(size_t index, bool done = true);
+        void reset_done();
+
+    protected:
+        bool _world_done(size_t index) const;
+
+        std::vector<simu_t> _simus;
+        // not std::vector<bool>: the flags are written concurrently by the workers
+        std::vector<char> _done;
+        ThreadPool _pool;
+    };
+} // namespace robot_dart
+
+#endif
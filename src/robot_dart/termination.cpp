@@ -0,0 +1,77 @@
+#include "termination.hpp"
+#include "utils.hpp"
+
+#include <cmath>
+
+#include <dart/dynamics/DegreeOfFreedom.hpp>
+
+namespace robot_dart {
+    namespace detail {
+        bool not_finite(Robot& robot)
+        {
+            // checked at every step: getPositions()/getVelocities() would allocate
+            auto skel = robot.skeleton();
+            for (size_t i = 0; i < skel->getNumDofs(); i++) {
+                auto dof = skel->getDof(i);
+                if (!std::isfinite(dof->getPosition()) || !std::isfinite(dof->getVelocity()))
+                    return true;
+            }
+            return false;
+        }
+    } // namespace detail
+
+    TerminationCondition TerminationCondition::com_below(const std::shared_ptr<Robot>& robot, double height)
+    {
+        ROBOT_DART_EXCEPTION_ASSERT(robot, "TerminationCondition: no robot given");
+
+        TerminationCondition condition;
+        condition.type = COM_BELOW;
+        condition.robot = robot;
+        condition.threshold = height;
+        return condition;
+    }
+
+    TerminationCondition TerminationCondition::body_outside_box(const std::shared_ptr<Robot>& robot, const std::string& body_name, const Eigen::Vector3d& box_min, const Eigen::Vector3d& box_max)
+    {
+        ROBOT_DART_EXCEPTION_ASSERT(robot, "TerminationCondition: no robot given");
+        auto bd = robot->skeleton()->getBodyNode(body_name);
+        ROBOT_DART_EXCEPTION_ASSERT(bd != nullptr, "TerminationCondition: BodyNode " + body_name + " does not exist in skeleton!");
+
+        TerminationCondition condition;
+        condition.type = BODY_OUTSIDE_BOX;
+        condition.robot = robot;
+        // resolved once: checking the condition does not search by name
+        condition.body_index = bd->getIndexInSkeleton();
+        condition.box_min = box_min;
+        condition.box_max = box_max;
+        return condition;
+    }
+
+    TerminationCondition TerminationCondition::not_finite(const std::shared_ptr<Robot>& robot)
+    {
+        TerminationCondition condition;
+        condition.type = NOT_FINITE;
+        condition.robot = robot;
+        return condition;
+    }
+
+    bool TerminationCondition::violated(const std::vector<std::shared_ptr<Robot>>& robots) const
+    {
+        switch (type) {
+        case COM_BELOW:
+            return robot->skeleton()->getCOM()[2] < threshold;
+        case BODY_OUTSIDE_BOX: {
+            Eigen::Vector3d pos = robot->skeleton()->getBodyNode(body_index)->getWorldTransform().translation();
+            return (pos.array() < box_min.array()).any() || (pos.array() > box_max.array()).any();
+        }
+        case NOT_FINITE:
+            if (robot)
+                return detail::not_finite(*robot);
+            for (auto& r : robots)
+                if (detail::not_finite(*r))
+                    return true;
+            return false;
+        }
+        return false;
+    }
+} // namespace robot_dart
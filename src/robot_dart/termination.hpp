@@ -0,0 +1,31 @@
+#ifndef ROBOT_DART_TERMINATION_HPP
+#define ROBOT_DART_TERMINATION_HPP
+
+#include <robot_dart/robot.hpp>
+
+namespace robot_dart {
+    // Declarative early-termination condition of a simulation (see RobotDARTSimu::add_termination_condition).
+    // The conditions are plain data: checking them does not go through a virtual call.
+    struct TerminationCondition {
+        enum Type {
+            COM_BELOW, // the height of the center of mass of the robot is below threshold
+            BODY_OUTSIDE_BOX, // the position of a body is outside [box_min, box_max]
+            NOT_FINITE // NaN/inf in the positions or velocities of the robot (of all the robots without robot)
+        };
+
+        static TerminationCondition com_below(const std::shared_ptr<Robot>& robot, double height);
+        static TerminationCondition body_outside_box(const std::shared_ptr<Robot>& robot, const std::string& body_name, const Eigen::Vector3d& box_min, const Eigen::Vector3d& box_max);
+        static TerminationCondition not_finite(const std::shared_ptr<Robot>& robot = nullptr);
+
+        // true if the simulation should stop; robots are the robots of the simulation (used without robot)
+        bool violated(const std::vector<std::shared_ptr<Robot>>& robots) const;
+
+        Type type;
+        std::shared_ptr<Robot> robot;
+        size_t body_index = 0;
+        double threshold = 0.;
+        Eigen::Vector3d box_min = Eigen::Vector3d::Zero(), box_max = Eigen::Vector3d::Zero();
+    };
+} // namespace robot_dart
+
+#endif
@@ -0,0 +1,96 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace robot_dart {
+    ThreadPool::ThreadPool(size_t num_threads)
+    {
+        if (num_threads == 0)
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+        for (size_t i = 1; i < num_threads; i++)
+            _workers.emplace_back(&ThreadPool::_worker_loop, this, i);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _start_cv.notify_all();
+
+        for (auto& worker : _workers)
+            worker.join();
+    }
+
+    void ThreadPool::parallel_for(size_t n, const task_t& task)
+    {
+        if (n == 0)
+            return;
+
+        // nothing to share, avoid waking up the workers
+        if (_workers.empty() || n == 1) {
+            for (size_t i = 0; i < n; i++)
+                task(i, 0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _task = &task;
+            _num_tasks = n;
+            _next_task = 0;
+            _exception = nullptr;
+            _active_workers = _workers.size();
+            _generation++;
+        }
+        _start_cv.notify_all();
+
+        _run_tasks(0);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done_cv.wait(lock, [this] { return _active_workers == 0; });
+        _task = nullptr;
+
+        if (_exception)
+            std::rethrow_exception(_exception);
+    }
+
+    void ThreadPool::_worker_loop(size_t thread_id)
+    {
+        size_t generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _start_cv.wait(lock, [&] { return _stop || _generation != generation; });
+                if (_stop)
+                    return;
+                generation = _generation;
+            }
+
+            _run_tasks(thread_id);
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _active_workers--;
+            }
+            _done_cv.notify_one();
+        }
+    }
+
+    void ThreadPool::_run_tasks(size_t thread_id)
+    {
+        size_t i;
+        while ((i = _next_task.fetch_add(1)) < _num_tasks) {
+            try {
+                (*_task)(i, thread_id);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_exception)
+                    _exception = std::current_exception();
+            }
+        }
+    }
+} // namespace robot_dart
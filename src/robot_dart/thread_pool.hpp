@@ -0,0 +1,51 @@
+#ifndef ROBOT_DART_THREAD_POOL_HPP
+#define ROBOT_DART_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace robot_dart {
+    // Fixed-size pool of worker threads that are created once and re-used for every job.
+    // The thread calling parallel_for() takes part in the work (as thread 0), so a pool
+    // of N threads only spawns N - 1 workers.
+    class ThreadPool {
+    public:
+        using task_t = std::function<void(size_t index, size_t thread_id)>;
+
+        // num_threads == 0 uses all the available hardware threads
+        ThreadPool(size_t num_threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t num_threads() const { return _workers.size() + 1; }
+
+        // calls task(i, thread_id) for every i in [0, n) and blocks until all calls are done
+        // indices are handed out dynamically, thread_id is in [0, num_threads())
+        // the first exception thrown by a task is re-thrown here
+        void parallel_for(size_t n, const task_t& task);
+
+    protected:
+        void _worker_loop(size_t thread_id);
+        void _run_tasks(size_t thread_id);
+
+        std::vector<std::thread> _workers;
+        std::mutex _mutex;
+        std::condition_variable _start_cv, _done_cv;
+
+        const task_t* _task = nullptr;
+        size_t _num_tasks = 0;
+        std::atomic<size_t> _next_task{0};
+        size_t _generation = 0, _active_workers = 0;
+        bool _stop = false;
+        std::exception_ptr _exception;
+    };
+} // namespace robot_dart
+
+#endif
@@ -66,6 +66,16 @@ BOOST_AUTO_TEST_CASE(test_pd_control)
     // change weight
     pd_control->set_weight(30.0);
     BOOST_CHECK(pd_control->weight() == 30.0);
+
+    // in-place version: same output, the buffer is re-used
+    pendulum->set_positions(Eigen::VectorXd::Constant(1, 0.5), pd_control->controllable_dof_view());
+    pendulum->set_velocities(Eigen::VectorXd::Constant(1, -1.), pd_control->controllable_dof_view());
+    Eigen::VectorXd commands(1);
+    const double* buffer = commands.data();
+    pd_control->calculate_into(0., commands);
+    BOOST_CHECK(commands.data() == buffer);
+    BOOST_CHECK(commands == pd_control->calculate(0.));
+    BOOST_CHECK_CLOSE(commands(0), 10. * (1. - 0.5) + 20. * 1., 1e-9);
 }
 
 BOOST_AUTO_TEST_CASE(test_simple_control)
@@ -6,9 +6,15 @@
 
 #include <dart/dynamics/BodyNode.hpp>
 #include <dart/dynamics/BoxShape.hpp>
+#include <dart/dynamics/CapsuleShape.hpp>
 #include <dart/dynamics/EllipsoidShape.hpp>
 
+#include <robot_dart/collision_shape_cache.hpp>
+#include <robot_dart/control/pd_control.hpp>
+#include <robot_dart/damage_variants.hpp>
+#include <robot_dart/model_cache.hpp>
 #include <robot_dart/robot.hpp>
+#include <robot_dart/robot_prototype.hpp>
 #include <robot_dart/utils.hpp>
 
 using namespace robot_dart;
@@ -82,6 +88,20 @@ BOOST_AUTO_TEST_CASE(test_actuators)
     for (size_t i = 0; i < types.size(); i++) {
         BOOST_CHECK(types[i] == "passive");
     }
+    // the cached DoF lists follow the actuator types
+    BOOST_CHECK(pexod->passive_dof_names().size() == pexod->num_dofs());
+    BOOST_CHECK(pexod->dof_names(true, true, true).empty());
+    BOOST_CHECK(pexod->dof_names().size() == pexod->num_dofs());
+    size_t version = pexod->dof_names_version();
+    pexod->set_actuator_types("torque");
+    BOOST_CHECK(pexod->dof_names_version() != version);
+    BOOST_CHECK(pexod->passive_dof_names().empty());
+    BOOST_CHECK(pexod->dof_names(true, true, true).size() == pexod->num_dofs());
+    // reading the lists does not rebuild them
+    version = pexod->dof_names_version();
+    pexod->dof_names();
+    BOOST_CHECK_EQUAL(pexod->dof_names_version(), version);
+    pexod->set_actuator_types("passive", {}, true, true);
 
     // check simple dof setting
     pexod->set_actuator_type("torque", pexod->joint_names()[0]);
@@ -146,6 +166,262 @@ BOOST_AUTO_TEST_CASE(test_actuators)
     BOOST_CHECK(pexod->damping_coeff(0) == 10.0);
 }
 
+BOOST_AUTO_TEST_CASE(test_dof_view)
+{
+    auto pexod = std::make_shared<Robot>(std::string(RESPATH) + "/models/pexod.urdf");
+    BOOST_REQUIRE(pexod);
+    pexod->fix_to_world();
+
+    auto names = pexod->dof_names();
+    std::vector<std::string> dofs = {names[5], names[0], names[3]};
+    auto view = pexod->dof_view(dofs);
+
+    Eigen::VectorXd q = Eigen::VectorXd::Random(3);
+    pexod->set_positions(q, view);
+    BOOST_CHECK(pexod->positions(dofs) == q);
+    BOOST_CHECK(pexod->positions(view) == q);
+
+    // all the DoFs
+    BOOST_CHECK(pexod->velocities(DofView()) == pexod->velocities());
+
+    // the indices change (6 more DoFs): the view is resolved again
+    pexod->free_from_world();
+    BOOST_CHECK(pexod->positions(view) == pexod->positions(dofs));
+
+    // a view used with several robots (e.g., in cloned controllers) is resolved for each of them
+    auto fixed = pexod->clone();
+    fixed->fix_to_world();
+    fixed->set_positions(Eigen::VectorXd::Random(fixed->num_dofs()));
+    BOOST_CHECK(fixed->dof_names_version() != pexod->dof_names_version());
+    for (int i = 0; i < 2; i++) {
+        BOOST_CHECK(fixed->positions(view) == fixed->positions(dofs));
+        BOOST_CHECK(pexod->positions(view) == pexod->positions(dofs));
+    }
+
+    BOOST_CHECK_THROW(pexod->dof_view({"not_a_dof"}), Assertion);
+
+    // write into a segment of a larger (preallocated) buffer
+    size_t n = pexod->num_dofs();
+    Eigen::VectorXd obs = Eigen::VectorXd::Zero(2 * n + 4);
+    pexod->state_into(obs.segment(1, 2 * n));
+    BOOST_CHECK(obs.segment(1, n) == pexod->positions());
+    BOOST_CHECK(obs.segment(1 + n, n) == pexod->velocities());
+    pexod->positions_into(obs.tail(3), view);
+    BOOST_CHECK(obs.tail(3) == pexod->positions(dofs));
+}
+
+BOOST_AUTO_TEST_CASE(test_body_view)
+{
+    auto pexod = std::make_shared<Robot>(std::string(RESPATH) + "/models/pexod.urdf");
+    BOOST_REQUIRE(pexod);
+    pexod->set_positions(Eigen::VectorXd::Random(pexod->num_dofs()));
+    pexod->set_velocities(Eigen::VectorXd::Random(pexod->num_dofs()));
+
+    auto names = pexod->body_names();
+    std::vector<std::string> bodies = {names[4], names[1]};
+    auto view = pexod->body_view(bodies);
+    BOOST_CHECK_THROW(pexod->body_view({"not_a_body"}), Assertion);
+
+    Robot::poses_t poses;
+    pexod->body_poses_into(poses, view);
+    BOOST_REQUIRE(poses.size() == 2);
+    BOOST_CHECK(poses[0].isApprox(pexod->body_pose(names[4])));
+    BOOST_CHECK(poses[1].isApprox(pexod->body_pose(names[1])));
+
+    // all the bodies
+    pexod->body_poses_into(poses);
+    BOOST_CHECK(poses.size() == pexod->num_bodies());
+
+    Eigen::MatrixXd twists(6, 2);
+    pexod->body_twists_into(twists, view);
+    auto bd = pexod->skeleton()->getBodyNode(names[1]);
+    BOOST_CHECK(twists.col(1).isApprox(bd->getSpatialVelocity(dart::dynamics::Frame::World(), dart::dynamics::Frame::World())));
+
+    Eigen::MatrixXd jacobians(6, pexod->num_dofs());
+    pexod->body_linear_jacobians_into(jacobians, view);
+    BOOST_CHECK(jacobians.bottomRows(3).isApprox(pexod->skeleton()->getLinearJacobian(bd)));
+    // the linear velocity of the body origin
+    BOOST_CHECK((jacobians.bottomRows(3) * pexod->velocities()).isApprox(twists.col(1).tail(3)));
+}
+
+BOOST_AUTO_TEST_CASE(test_external_wrenches)
+{
+    auto pexod = std::make_shared<Robot>(std::string(RESPATH) + "/models/pexod.urdf");
+    BOOST_REQUIRE(pexod);
+
+    Robot::wrenches_t wrenches = Robot::wrenches_t::Random(2, 6);
+    pexod->set_external_wrenches({3, 1}, wrenches);
+    // external_forces() gives the torques about the world origin: only compare the forces
+    BOOST_CHECK(pexod->external_forces(3).tail(3).isApprox(wrenches.row(0).tail(3).transpose()));
+    BOOST_CHECK(pexod->external_forces(1).tail(3).isApprox(wrenches.row(1).tail(3).transpose()));
+
+    auto view = pexod->body_view({pexod->body_name(3)});
+    pexod->add_external_wrenches(view, wrenches.topRows(1));
+    BOOST_CHECK(pexod->external_forces(3).tail(3).isApprox(2. * wrenches.row(0).tail(3).transpose()));
+
+    // nothing is applied if one of the bodies is invalid
+    pexod->clear_external_forces();
+    pexod->set_external_wrenches({0, pexod->num_bodies()}, wrenches);
+    BOOST_CHECK(pexod->external_forces(0).isZero());
+}
+
+BOOST_AUTO_TEST_CASE(test_model_cache)
+{
+    auto& cache = ModelCache::instance();
+    std::string model = std::string(RESPATH) + "/models/pexod.urdf";
+    cache.clear();
+
+    BOOST_CHECK(cache.preload(model));
+    BOOST_CHECK(cache.size() == 1);
+    BOOST_CHECK(!cache.preload("/tmp/bad-path.urdf"));
+
+    // each robot gets its own skeleton
+    auto pexod1 = std::make_shared<Robot>(model, "pexod1");
+    auto pexod2 = std::make_shared<Robot>(model, "pexod2");
+    BOOST_CHECK(cache.size() == 1);
+    BOOST_CHECK(pexod1->skeleton() != pexod2->skeleton());
+    BOOST_CHECK(pexod1->skeleton()->getName() == "pexod1");
+    BOOST_CHECK(pexod1->num_dofs() == pexod2->num_dofs());
+
+    pexod1->set_positions(Eigen::VectorXd::Constant(pexod1->num_dofs(), 0.1));
+    BOOST_CHECK(pexod2->positions().isZero());
+    // the cached model is not modified by the robots
+    auto pexod3 = std::make_shared<Robot>(model);
+    BOOST_CHECK(pexod3->positions().isZero());
+
+    cache.evict(model);
+    BOOST_CHECK(cache.size() == 0);
+
+    // the robots do not share their shapes with the cached model (nor with each other)
+    std::vector<std::pair<std::string, std::string>> packages = {{"iiwa14", std::string(RESPATH) + "/models/meshes"}};
+    std::string iiwa = std::string(RESPATH) + "/models/iiwa14.urdf";
+    auto iiwa1 = std::make_shared<Robot>(iiwa, packages, "iiwa1");
+    auto iiwa2 = std::make_shared<Robot>(iiwa, packages, "iiwa2");
+    auto color_mode = [](const std::shared_ptr<Robot>& robot) -> dart::dynamics::MeshShape::ColorMode {
+        for (size_t i = 0; i < robot->skeleton()->getNumShapeNodes(); i++) {
+            auto sn = robot->skeleton()->getShapeNode(i);
+            auto mesh = std::dynamic_pointer_cast<dart::dynamics::MeshShape>(sn->getShape());
+            if (sn->getVisualAspect() && mesh)
+                return mesh->getColorMode();
+        }
+        return dart::dynamics::MeshShape::ColorMode::MATERIAL_COLOR;
+    };
+    BOOST_CHECK(color_mode(iiwa1) == dart::dynamics::MeshShape::ColorMode::SHAPE_COLOR);
+    BOOST_CHECK(iiwa1->skeleton()->getShapeNode(0)->getShape() != iiwa2->skeleton()->getShapeNode(0)->getShape());
+    iiwa1->set_color_mode(dart::dynamics::MeshShape::ColorMode::MATERIAL_COLOR);
+    BOOST_CHECK(color_mode(iiwa1) == dart::dynamics::MeshShape::ColorMode::MATERIAL_COLOR);
+    BOOST_CHECK(color_mode(iiwa2) == dart::dynamics::MeshShape::ColorMode::SHAPE_COLOR);
+    auto iiwa3 = std::make_shared<Robot>(iiwa, packages, "iiwa3");
+    BOOST_CHECK(color_mode(iiwa3) == dart::dynamics::MeshShape::ColorMode::SHAPE_COLOR);
+
+    cache.evict(iiwa);
+}
+
+BOOST_AUTO_TEST_CASE(test_simplify_collision_shapes)
+{
+    std::string mesh = std::string(RESPATH) + "/models/meshes/link_1.stl";
+    std::string urdf = "<?xml version=\"1.0\"?><robot name=\"link\"><link name=\"link_1\">"
+                       "<inertial><mass value=\"1\"/><inertia ixx=\"0.01\" ixy=\"0\" ixz=\"0\" iyy=\"0.01\" iyz=\"0\" izz=\"0.01\"/></inertial>"
+                       "<visual><geometry><mesh filename=\""
+        + mesh + "\"/></geometry></visual>"
+                 "<collision><geometry><mesh filename=\""
+        + mesh + "\"/></geometry></collision>"
+                 "</link></robot>";
+
+    auto& cache = CollisionShapeCache::instance();
+    auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    cache.set_directory(directory.string());
+    cache.clear();
+
+    for (std::string type : {"convex_hull", "box", "capsule"}) {
+        auto robot = std::make_shared<Robot>(urdf, "link", true);
+        auto bd = robot->skeleton()->getBodyNode(0);
+        BOOST_REQUIRE(bd->getNumShapeNodesWith<dart::dynamics::CollisionAspect>() == 1);
+
+        BOOST_CHECK(robot->simplify_collision_shapes(type) == 1);
+        BOOST_REQUIRE(bd->getNumShapeNodesWith<dart::dynamics::CollisionAspect>() == 1);
+        auto shape = bd->getShapeNodesWith<dart::dynamics::CollisionAspect>()[0]->getShape();
+        if (type == "convex_hull")
+            BOOST_CHECK(std::dynamic_pointer_cast<dart::dynamics::MeshShape>(shape));
+        else if (type == "box")
+            BOOST_CHECK(std::dynamic_pointer_cast<dart::dynamics::BoxShape>(shape));
+        else
+            BOOST_CHECK(std::dynamic_pointer_cast<dart::dynamics::CapsuleShape>(shape));
+
+        // the visual mesh is untouched
+        BOOST_REQUIRE(bd->getNumShapeNodesWith<dart::dynamics::VisualAspect>() == 1);
+        auto visual = bd->getShapeNodesWith<dart::dynamics::VisualAspect>()[0];
+        BOOST_CHECK(!visual->getCollisionAspect());
+        BOOST_CHECK(std::dynamic_pointer_cast<dart::dynamics::MeshShape>(visual->getShape()));
+
+        // nothing left to simplify
+        BOOST_CHECK(robot->simplify_collision_shapes(type) == 0);
+    }
+
+    // one hull on disk, shared in memory
+    BOOST_CHECK(cache.size() == 1);
+    BOOST_CHECK(std::distance(boost::filesystem::directory_iterator(directory), boost::filesystem::directory_iterator()) == 1);
+    auto robot = std::make_shared<Robot>(urdf, "link", true);
+    robot->simplify_collision_shapes();
+    BOOST_CHECK(cache.size() == 1);
+
+    auto pexod = std::make_shared<Robot>(std::string(RESPATH) + "/models/pexod.urdf");
+    BOOST_CHECK_THROW(pexod->simplify_collision_shapes("sphere"), Assertion);
+
+    boost::filesystem::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_CASE(test_robot_prototype)
+{
+    auto pexod = std::make_shared<Robot>(std::string(RESPATH) + "/models/pexod.urdf");
+    BOOST_REQUIRE(pexod);
+    pexod->fix_to_world();
+    pexod->add_controller(std::make_shared<control::PDControl>(Eigen::VectorXd::Zero(pexod->num_dofs())));
+
+    RobotPrototype prototype(pexod);
+    // later changes of the robot are not seen by the prototype
+    pexod->free_from_world();
+
+    auto robots = prototype.clone_n(8, 4);
+    BOOST_REQUIRE(robots.size() == 8);
+    for (auto& robot : robots) {
+        BOOST_REQUIRE(robot);
+        BOOST_CHECK(robot->fixed());
+        BOOST_CHECK(robot->num_controllers() == 1);
+        BOOST_CHECK(robot->controller(0)->robot() == robot);
+    }
+    BOOST_CHECK(robots[0]->skeleton() != robots[1]->skeleton());
+    BOOST_CHECK(prototype.clone("other")->name() == "other");
+}
+
+BOOST_AUTO_TEST_CASE(test_damage_variants)
+{
+    auto pexod = std::make_shared<Robot>(std::string(RESPATH) + "/models/pexod.urdf");
+    BOOST_REQUIRE(pexod);
+    pexod->fix_to_world();
+    std::string joint = pexod->joint_name(3);
+
+    DamageVariants variants(pexod);
+    auto damaged = variants.robot({RobotDamage("blocked_joint", joint)}, "damaged");
+    BOOST_CHECK(damaged->name() == "damaged");
+    BOOST_CHECK(damaged->actuator_type(joint) == "locked");
+    BOOST_CHECK(pexod->actuator_type(joint) != "locked");
+    BOOST_REQUIRE(damaged->damages().size() == 1);
+    BOOST_CHECK(damaged->damages()[0].data == joint);
+
+    // same damage by index: same variant
+    BOOST_CHECK(variants.signature({RobotDamage("blocked_joint", 3)}) == variants.signature({RobotDamage("blocked_joint", joint)}));
+    auto other = variants.robot({RobotDamage("blocked_joint", 3)});
+    BOOST_CHECK(variants.size() == 1);
+    BOOST_CHECK(other->skeleton() != damaged->skeleton());
+    BOOST_CHECK(other->actuator_type(joint) == "locked");
+
+    variants.preload({RobotDamage("free_joint", 4)});
+    BOOST_CHECK(variants.size() == 2);
+    BOOST_CHECK_THROW(variants.robot({RobotDamage("free_joint", "not_a_joint")}), Assertion);
+    BOOST_CHECK_THROW(variants.robot({RobotDamage("free_joint", pexod->num_joints())}), Assertion);
+}
+
 BOOST_AUTO_TEST_CASE(test_static_creation)
 {
     // box creation tests
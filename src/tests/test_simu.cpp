@@ -0,0 +1,632 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_simu
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+#include <robot_dart/control/pd_control.hpp>
+#include <robot_dart/control/policy_control.hpp>
+#include <robot_dart/descriptor/sensor_buffer.hpp>
+#include <robot_dart/gui_data.hpp>
+#include <robot_dart/profiler.hpp>
+#include <robot_dart/population_evaluator.hpp>
+#include <robot_dart/recorder.hpp>
+#include <robot_dart/robot_dart_simu.hpp>
+#include <robot_dart/scheduler.hpp>
+#include <robot_dart/simu_batch.hpp>
+#include <robot_dart/thread_pool.hpp>
+#include <robot_dart/utils.hpp>
+
+#include <dart/collision/CollisionObject.hpp>
+
+using namespace robot_dart;
+
+BOOST_AUTO_TEST_CASE(test_save_restore_state)
+{
+    auto arm = std::make_shared<Robot>(std::string(RESPATH) + "/models/arm.urdf");
+    BOOST_REQUIRE(arm);
+    arm->fix_to_world();
+
+    Eigen::VectorXd ctrl = Eigen::VectorXd::Constant(arm->dof_names(true, true, true).size(), 0.5);
+    arm->add_controller(std::make_shared<control::PDControl>(ctrl));
+
+    RobotDARTSimu simu(0.001);
+    simu.set_control_freq(100);
+    simu.add_robot(arm);
+    simu.run(0.5);
+
+    SimuState state = simu.save_state();
+    double time = simu.world()->getTime();
+    Eigen::VectorXd positions = arm->positions();
+    Eigen::VectorXd velocities = arm->velocities();
+
+    simu.run(0.5);
+    Eigen::VectorXd final_positions = arm->positions();
+    double final_time = simu.world()->getTime();
+
+    // restoring brings back the exact state
+    simu.restore_state(state);
+    BOOST_CHECK(simu.world()->getTime() == time);
+    BOOST_CHECK(simu.scheduler().current_time() == time);
+    BOOST_CHECK(arm->positions() == positions);
+    BOOST_CHECK(arm->velocities() == velocities);
+
+    // and the rollout is deterministic
+    simu.run(0.5);
+    BOOST_CHECK(simu.world()->getTime() == final_time);
+    BOOST_CHECK(arm->positions() == final_positions);
+
+    // re-using the buffer gives the same snapshot
+    SimuState other;
+    simu.restore_state(state);
+    simu.save_state(other);
+    BOOST_CHECK(other.data == state.data);
+    BOOST_CHECK(other.layout == state.layout);
+
+    // a truncated snapshot is rejected (nothing is restored)
+    simu.run(0.1);
+    double current_time = simu.world()->getTime();
+    other.data.pop_back();
+    simu.restore_state(other);
+    BOOST_CHECK(simu.world()->getTime() == current_time);
+}
+
+// stateful controller (PolicyControl): PD towards the parameters, queried at 20Hz (the commands are held in-between)
+struct HoldPDPolicy {
+    void set_params(const Eigen::VectorXd& params) { target = params; }
+    size_t output_size() const { return target.size(); }
+    Eigen::VectorXd query(const std::shared_ptr<Robot>& robot, double) { return 10. * (target - robot->positions()) - robot->velocities(); }
+
+    void set_h_params(const Eigen::VectorXd&) {}
+    Eigen::VectorXd h_params() const { return Eigen::VectorXd(); }
+
+    Eigen::VectorXd target;
+};
+
+BOOST_AUTO_TEST_CASE(test_record_replay)
+{
+    auto make_arm = []() {
+        auto arm = std::make_shared<Robot>(std::string(RESPATH) + "/models/arm.urdf");
+        arm->fix_to_world();
+        return arm;
+    };
+
+    auto filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%-%%%%-%%%%.bin")).string();
+    size_t dofs = make_arm()->dof_names(true, true, true).size();
+    Eigen::VectorXd ctrl = Eigen::VectorXd::Constant(dofs, 0.5);
+    std::vector<std::shared_ptr<control::RobotControl>> controllers = {std::make_shared<control::PDControl>(ctrl), std::make_shared<control::PolicyControl<HoldPDPolicy>>(0.05, ctrl)};
+
+    for (auto& controller : controllers) {
+        // record a controlled episode (started after some time)
+        auto arm = make_arm();
+        arm->add_controller(controller);
+
+        RobotDARTSimu simu(0.001);
+        simu.set_control_freq(100);
+        simu.add_robot(arm);
+        simu.run(0.2);
+
+        auto recorder = std::make_shared<Recorder>(filename, 10);
+        simu.set_recorder(recorder);
+        simu.run(0.5);
+        simu.set_recorder(nullptr);
+        recorder->close();
+        BOOST_CHECK(recorder->num_ticks() == 50);
+
+        // replay it without controllers (the state of the controllers in the keyframes is skipped)
+        auto replay_arm = make_arm();
+        RobotDARTSimu replay_simu(0.001);
+        replay_simu.add_robot(replay_arm);
+
+        Replayer replayer(filename);
+        BOOST_CHECK(replayer.timestep() == 0.001);
+        BOOST_CHECK(replayer.control_freq() == 100);
+        replayer.run(replay_simu);
+        BOOST_CHECK(replayer.done());
+
+        BOOST_CHECK(replay_simu.world()->getTime() == simu.world()->getTime());
+        BOOST_CHECK(replay_arm->positions() == arm->positions());
+        BOOST_CHECK(replay_arm->velocities() == arm->velocities());
+
+        // the state of a stateful controller cannot be restored without it
+        SimuState state = simu.save_state();
+        BOOST_CHECK(replay_simu.restore_state(state) == (controller->state_size() == 0));
+        BOOST_CHECK(replay_simu.restore_state(state, false));
+    }
+
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(test_step_profiler)
+{
+    // the samples can be added by hand (with or without --profiling)
+    StepProfiler profiler;
+    BOOST_CHECK(profiler.stats(StepProfiler::WORLD_STEP).count == 0);
+
+    for (int i = 0; i < 99; i++)
+        profiler.add_sample(StepProfiler::WORLD_STEP, 1.);
+    profiler.add_sample(StepProfiler::WORLD_STEP, 1000.);
+    auto stats = profiler.stats(StepProfiler::WORLD_STEP);
+    BOOST_CHECK(stats.count == 100);
+    BOOST_CHECK(stats.min == 1.);
+    BOOST_CHECK(stats.max == 1000.);
+    BOOST_CHECK_CLOSE(stats.total, 1099., 1e-9);
+    BOOST_CHECK_CLOSE(stats.mean, 10.99, 1e-9);
+    // upper edge of the bucket of 1us (4 buckets per octave from 0.1us)
+    BOOST_CHECK_CLOSE(stats.p99, 0.1 * std::pow(2., 14. / 4.), 1e-9);
+    BOOST_CHECK(stats.p99 > 1. && stats.p99 < 1. * std::pow(2., 1. / 4.));
+    // the other phases are not changed
+    BOOST_CHECK(profiler.stats(StepProfiler::GRAPHICS).count == 0);
+
+    // the p99 is clamped to the samples
+    profiler.add_sample(StepProfiler::GRAPHICS, 1.);
+    BOOST_CHECK(profiler.stats(StepProfiler::GRAPHICS).p99 == 1.);
+    // below the first bucket and beyond the last one
+    profiler.add_sample(StepProfiler::CAMERAS, 0.01);
+    BOOST_CHECK(profiler.stats(StepProfiler::CAMERAS).p99 == 0.01);
+    profiler.add_sample(StepProfiler::DESCRIPTORS, 1e10);
+    BOOST_CHECK(profiler.stats(StepProfiler::DESCRIPTORS).p99 == 1e10);
+
+    profiler.reset();
+    for (int i = 0; i < StepProfiler::NUM_PHASES; i++) {
+        stats = profiler.stats(static_cast<StepProfiler::Phase>(i));
+        BOOST_CHECK(stats.count == 0);
+        BOOST_CHECK(stats.total == 0.);
+    }
+    profiler.add_sample(StepProfiler::WORLD_STEP, 2.);
+    BOOST_CHECK(profiler.stats(StepProfiler::WORLD_STEP).min == 2.);
+    BOOST_CHECK(profiler.stats(StepProfiler::WORLD_STEP).max == 2.);
+}
+
+BOOST_AUTO_TEST_CASE(test_thread_pool)
+{
+    ThreadPool pool(4);
+    BOOST_REQUIRE_EQUAL(pool.num_threads(), 4u);
+    auto caller = std::this_thread::get_id();
+
+    // every index is run exactly once, and thread 0 is the calling thread
+    std::vector<int> counts(1000, 0);
+    std::atomic<bool> ids_ok(true);
+    pool.parallel_for(counts.size(), [&](size_t i, size_t thread_id) {
+        counts[i]++;
+        if (thread_id >= 4 || ((thread_id == 0) != (std::this_thread::get_id() == caller)))
+            ids_ok = false;
+    });
+    BOOST_CHECK(std::all_of(counts.begin(), counts.end(), [](int c) { return c == 1; }));
+    BOOST_CHECK(ids_ok);
+
+    // one task per thread, each waiting for all the others: the calling thread has to take one
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t arrived = 0;
+    std::vector<size_t> thread_ids;
+    pool.parallel_for(4, [&](size_t, size_t thread_id) {
+        std::unique_lock<std::mutex> lock(mutex);
+        arrived++;
+        thread_ids.push_back(thread_id);
+        cv.notify_all();
+        cv.wait_for(lock, std::chrono::seconds(5), [&] { return arrived == 4; });
+    });
+    std::sort(thread_ids.begin(), thread_ids.end());
+    BOOST_CHECK(thread_ids == std::vector<size_t>({0, 1, 2, 3}));
+
+    // the workers are re-used for every job
+    for (size_t generation = 0; generation < 200; generation++) {
+        std::atomic<size_t> sum(0);
+        pool.parallel_for(generation % 17, [&](size_t i, size_t) { sum += i + 1; });
+        size_t n = generation % 17;
+        BOOST_CHECK_EQUAL(sum.load(), n * (n + 1) / 2);
+    }
+
+    // the first exception is re-thrown once all the tasks are done, and the pool is still usable
+    std::atomic<size_t> done(0);
+    BOOST_CHECK_THROW(pool.parallel_for(100, [&](size_t i, size_t) {
+        done++;
+        if (i % 10 == 7)
+            throw std::runtime_error("task failed");
+    }),
+        std::runtime_error);
+    BOOST_CHECK_EQUAL(done.load(), 100u);
+    std::atomic<size_t> count(0);
+    pool.parallel_for(10, [&](size_t, size_t) { count++; });
+    BOOST_CHECK_EQUAL(count.load(), 10u);
+}
+
+BOOST_AUTO_TEST_CASE(test_simu_batch)
+{
+    auto global_robot = std::make_shared<Robot>(std::string(RESPATH) + "/models/arm.urdf");
+    global_robot->fix_to_world();
+    size_t dofs = global_robot->dof_names(true, true, true).size();
+
+    // the same worlds, stepped in parallel and one after the other
+    SimuBatch batch(4, 0.001, 2);
+    BOOST_CHECK_EQUAL(batch.size(), 4u);
+    BOOST_CHECK_EQUAL(batch.num_threads(), 2u);
+    std::vector<std::shared_ptr<RobotDARTSimu>> sequential;
+    for (size_t i = 0; i < batch.size(); i++) {
+        Eigen::VectorXd target = Eigen::VectorXd::Constant(dofs, 0.2 * i - 0.3);
+        sequential.push_back(std::make_shared<RobotDARTSimu>(0.001));
+        for (auto simu : {batch.simu(i), sequential.back()}) {
+            auto robot = global_robot->clone();
+            robot->add_controller(std::make_shared<control::PDControl>(target));
+            simu->add_robot(robot);
+        }
+    }
+
+    for (int k = 0; k < 100; k++)
+        BOOST_CHECK(!batch.step());
+    batch.run(0.4);
+    for (auto& simu : sequential) {
+        for (int k = 0; k < 100; k++)
+            simu->step();
+        simu->run(0.4);
+    }
+
+    for (size_t i = 0; i < batch.size(); i++) {
+        BOOST_CHECK(batch.simu(i)->world()->getTime() == sequential[i]->world()->getTime());
+        BOOST_CHECK(batch.simu(i)->robot(0)->positions() == sequential[i]->robot(0)->positions());
+    }
+    BOOST_CHECK(batch.simu(0)->robot(0)->positions() != batch.simu(3)->robot(0)->positions());
+
+    // halted worlds are not stepped anymore
+    batch.simu(1)->stop_sim();
+    BOOST_CHECK(!batch.step());
+    BOOST_CHECK(batch.done(1));
+    double time = batch.simu(1)->world()->getTime();
+    batch.step();
+    BOOST_CHECK(batch.simu(1)->world()->getTime() == time);
+    BOOST_CHECK_EQUAL(batch.num_done(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_population_evaluator)
+{
+    auto global_robot = std::make_shared<Robot>(std::string(RESPATH) + "/models/arm.urdf");
+    global_robot->fix_to_world();
+    size_t dofs = global_robot->dof_names(true, true, true).size();
+
+    auto factory = [&]() {
+        auto robot = global_robot->clone();
+        robot->add_controller(std::make_shared<control::PDControl>(Eigen::VectorXd::Zero(dofs)));
+        auto simu = std::make_shared<RobotDARTSimu>(0.001);
+        simu->add_robot(robot);
+        return simu;
+    };
+    auto descriptor = [](RobotDARTSimu& simu) -> Eigen::VectorXd { return simu.robot(0)->positions(); };
+
+    PopulationEvaluator evaluator(factory, 0.5, 2);
+    BOOST_CHECK(evaluator.num_threads() == 2);
+    BOOST_CHECK(evaluator.simus().size() == 2);
+
+    Eigen::MatrixXd params(4, dofs);
+    params.row(0) = Eigen::VectorXd::Constant(dofs, 0.5).transpose();
+    params.row(1) = Eigen::VectorXd::Constant(dofs, -0.5).transpose();
+    params.row(2) = params.row(0);
+    params.row(3) = params.row(1);
+
+    Eigen::MatrixXd out = evaluator.evaluate(params, descriptor);
+    BOOST_REQUIRE(out.rows() == 4);
+    BOOST_CHECK(out.row(0) == out.row(2));
+    BOOST_CHECK(out.row(1) == out.row(3));
+
+    // same result as a simulation built from scratch
+    auto simu = factory();
+    simu->robot(0)->controller(0)->set_parameters(params.row(1).transpose());
+    simu->run(0.5);
+    BOOST_CHECK(descriptor(*simu).transpose() == out.row(1));
+}
+
+BOOST_AUTO_TEST_CASE(test_gui_data)
+{
+    auto arm = std::make_shared<Robot>(std::string(RESPATH) + "/models/arm.urdf");
+    BOOST_REQUIRE(arm);
+
+    RobotDARTSimu simu(0.001);
+    simu.add_robot(arm);
+
+    auto shape = arm->skeleton()->getBodyNode("arm_link_0")->getShapeNodesWith<dart::dynamics::VisualAspect>()[0];
+    BOOST_CHECK(simu.gui_data()->cast_shadows(shape));
+    BOOST_CHECK(!simu.gui_data()->ghost(shape));
+
+    // setting the same value is not a change
+    size_t version = arm->gui_version();
+    arm->set_cast_shadows(true);
+    BOOST_CHECK(arm->gui_version() == version);
+
+    // changes are picked up at the next graphics tick
+    arm->set_cast_shadows(false);
+    arm->set_draw_axis("arm_link_0");
+    BOOST_CHECK(arm->gui_version() != version);
+    simu.run(0.1);
+    BOOST_CHECK(!simu.gui_data()->cast_shadows(shape));
+    BOOST_CHECK(simu.gui_data()->drawing_axes().size() == 1);
+
+    arm->remove_all_drawing_axis();
+    simu.run(0.1);
+    BOOST_CHECK(simu.gui_data()->drawing_axes().empty());
+
+    // removing the robot removes its data
+    simu.remove_robot(0);
+    BOOST_CHECK(simu.gui_data()->cast_shadows(shape));
+}
+
+BOOST_AUTO_TEST_CASE(test_scheduler_tasks)
+{
+    Scheduler scheduler(1e-3);
+    int fast = scheduler.add_task(1000);
+    int slow = scheduler.add_task(50);
+    int odd = scheduler.add_task(30); // 33 steps: runs at ~30.3Hz
+
+    BOOST_CHECK_EQUAL(scheduler.task_period(slow), 20);
+    BOOST_CHECK_EQUAL(scheduler.task_period(odd), 33);
+    BOOST_CHECK_SMALL(scheduler.task_drift(slow), 1e-9);
+    BOOST_CHECK_CLOSE(scheduler.task_effective_frequency(odd), 1000. / 33., 1e-9);
+
+    for (int k = 0; k < 1000; k++) {
+        BOOST_CHECK(scheduler.runs(fast));
+        BOOST_CHECK_EQUAL(scheduler.runs(slow), k % 20 == 0);
+        BOOST_CHECK_EQUAL(scheduler.runs(odd), k % 33 == 0);
+        // the same frequency is the same task
+        BOOST_CHECK_EQUAL(scheduler(50), k % 20 == 0);
+        scheduler.step();
+    }
+    BOOST_CHECK_EQUAL(scheduler.num_tasks(), 3);
+
+    // jumping to another step keeps the tasks aligned with the multiples of their period
+    scheduler.set_state(660, 0.66, 0.);
+    BOOST_CHECK_EQUAL(scheduler.running_tasks(), 7u);
+    scheduler.set_task_frequency(slow, 100);
+    BOOST_CHECK_EQUAL(scheduler.task_period(slow), 10);
+    BOOST_CHECK(scheduler.runs(slow));
+    scheduler.step();
+    BOOST_CHECK(!scheduler.runs(slow));
+
+    BOOST_CHECK_THROW(scheduler.runs(3), Assertion);
+    BOOST_CHECK_THROW(scheduler.task_period(-1), Assertion);
+
+    // other frequencies are not registered: a larger time-step only fails when they are scheduled again
+    Scheduler other(1e-3);
+    BOOST_CHECK(other(1000));
+    BOOST_CHECK_EQUAL(other.num_tasks(), 0);
+    BOOST_CHECK_NO_THROW(other.reset(0.01));
+    BOOST_CHECK_THROW(other(1000), Assertion);
+}
+
+BOOST_AUTO_TEST_CASE(test_scheduler_sync)
+{
+    // bucketing of the lateness (in microseconds)
+    Scheduler::SyncStats stats;
+    stats.bucket_width = 10.;
+    stats.histogram.assign(5, 0);
+    for (double lateness : {-3., 0., 9.9, 10., 25., 49.9, 50., 1e6})
+        stats.add(lateness);
+    BOOST_CHECK_EQUAL(stats.steps, 8u);
+    // early releases count in the first bucket, and the last bucket counts everything above
+    BOOST_CHECK(stats.histogram == std::vector<size_t>({3, 1, 1, 0, 3}));
+    BOOST_CHECK_EQUAL(stats.max_lateness, 1e6);
+    BOOST_CHECK_CLOSE(stats.mean_lateness, (-3. + 9.9 + 10. + 25. + 49.9 + 50. + 1e6) / 8., 1e-9);
+
+    Scheduler scheduler(1e-3, true);
+    BOOST_CHECK_THROW(scheduler.set_spin_margin(-1.), Assertion);
+    scheduler.set_spin_margin(5e-4);
+    scheduler.set_jitter_histogram(200, 1.);
+    BOOST_CHECK_EQUAL(scheduler.sync_stats().histogram.size(), 200u);
+
+    // with a spin margin, no step is released before its deadline
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < 50; k++) {
+        scheduler(1000);
+        scheduler.step();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BOOST_CHECK(elapsed >= 50 * 1e-3 - 1e-4);
+    const auto& sync_stats = scheduler.sync_stats();
+    BOOST_CHECK_EQUAL(sync_stats.steps, 50u);
+    BOOST_CHECK_EQUAL(std::accumulate(sync_stats.histogram.begin(), sync_stats.histogram.end(), size_t(0)), 50u);
+    BOOST_CHECK(sync_stats.max_lateness >= 0.);
+
+    // long runs (the deadlines were computed with an int number of microseconds, which overflows after ~36 minutes)
+    scheduler.reset_sync_stats();
+    scheduler.set_state(3600000, 3600., 0.);
+    for (int k = 0; k < 20; k++) {
+        scheduler(1000);
+        scheduler.step();
+    }
+    BOOST_CHECK_EQUAL(scheduler.sync_stats().steps, 20u);
+    BOOST_CHECK(scheduler.sync_stats().max_lateness < 1e5);
+    BOOST_CHECK(scheduler.sync_stats().overruns < 20u);
+}
+
+BOOST_AUTO_TEST_CASE(test_termination_conditions)
+{
+    // free-floating arm: falls under gravity
+    auto arm = std::make_shared<Robot>(std::string(RESPATH) + "/models/arm.urdf");
+    BOOST_REQUIRE(arm);
+
+    RobotDARTSimu simu(0.001);
+    simu.add_robot(arm);
+    double height = arm->com()[2];
+
+    simu.add_termination_condition(TerminationCondition::not_finite());
+    simu.add_termination_condition(TerminationCondition::com_below(arm, height - 0.5));
+    simu.set_termination_freq(100);
+    simu.run(5.);
+
+    BOOST_CHECK(simu.halted_sim());
+    BOOST_CHECK_EQUAL(simu.terminated_by(), 1);
+    BOOST_CHECK(arm->com()[2] < height - 0.5);
+    // free fall: ~0.32s to fall 0.5m (checked every 10 steps)
+    BOOST_CHECK(simu.world()->getTime() < 0.4);
+
+    BOOST_CHECK_THROW(TerminationCondition::body_outside_box(arm, "no_body", Eigen::Vector3d::Constant(-1.), Eigen::Vector3d::Constant(1.)), Assertion);
+}
+
+BOOST_AUTO_TEST_CASE(test_sensor_buffer)
+{
+    auto pexod = std::make_shared<Robot>(std::string(RESPATH) + "/models/pexod.urdf");
+    BOOST_REQUIRE(pexod);
+    pexod->skeleton()->setPosition(5, 0.2);
+
+    RobotDARTSimu simu(0.001);
+    simu.add_floor();
+    simu.add_robot(pexod);
+
+    auto sensors = std::make_shared<descriptor::SensorBuffer>(&simu);
+    for (auto& name : pexod->body_names())
+        sensors->add_contact_body(pexod, name);
+    size_t ft = sensors->add_force_torque(pexod, 1);
+    BOOST_CHECK_THROW(sensors->add_contact_body(pexod, "no_body"), Assertion);
+    simu.add_descriptor(sensors);
+
+    // the robot falls and rests on the floor
+    simu.run(2.);
+    BOOST_CHECK(sensors->num_contacts() > 0);
+    BOOST_CHECK(sensors->dropped_contacts() == 0);
+    BOOST_CHECK(sensors->wrenches().col(ft) == pexod->force_torque(1).second);
+
+    // at rest, the contacts carry the weight of the robot
+    double weight = pexod->skeleton()->getMass() * 9.81;
+    Eigen::Vector3d total = sensors->body_contact_forces().rowwise().sum();
+    BOOST_CHECK_CLOSE(total[2], weight, 10.);
+    for (size_t i = 0; i < sensors->num_contacts(); i++)
+        BOOST_CHECK(sensors->contact_normals().col(i)[2] > 0.);
+}
+
+BOOST_AUTO_TEST_CASE(test_collision_groups)
+{
+    RobotDARTSimu simu(0.001);
+    simu.add_floor();
+    // two robots at the same place that only collide with the floor
+    for (size_t i = 0; i < 2; i++) {
+        auto pexod = std::make_shared<Robot>(std::string(RESPATH) + "/models/pexod.urdf");
+        BOOST_REQUIRE(pexod);
+        pexod->skeleton()->setPosition(5, 0.2);
+        simu.add_robot(pexod);
+        simu.set_collision_mask(i, 1 << i);
+    }
+
+    BOOST_CHECK(!simu.collision_groups_enabled());
+    BOOST_CHECK_EQUAL(simu.num_collision_groups(), 0);
+    simu.enable_collision_groups();
+    BOOST_CHECK(simu.collision_groups_enabled());
+    // floor (no mask), robot 0, robot 1
+    BOOST_CHECK_EQUAL(simu.num_collision_groups(), 3);
+
+    simu.run(1.);
+    const auto& result = simu.world()->getLastCollisionResult();
+    BOOST_CHECK(result.getNumContacts() > 0);
+    auto floor = simu.world()->getSkeleton("floor");
+    for (size_t i = 0; i < result.getNumContacts(); i++) {
+        const auto& contact = result.getContact(i);
+        BOOST_CHECK(contact.collisionObject1->getShapeFrame()->asShapeNode()->getSkeleton() == floor
+            || contact.collisionObject2->getShapeFrame()->asShapeNode()->getSkeleton() == floor);
+    }
+    // both robots rest on the floor
+    BOOST_CHECK_CLOSE(simu.robot(0)->com()[2], simu.robot(1)->com()[2], 1.);
+
+    // the groups follow the masks
+    simu.set_collision_mask(1, 1);
+    BOOST_CHECK_EQUAL(simu.num_collision_groups(), 2);
+    simu.remove_all_collision_masks();
+    BOOST_CHECK_EQUAL(simu.num_collision_groups(), 1);
+    simu.enable_collision_groups(false);
+    BOOST_CHECK_EQUAL(simu.num_collision_groups(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_probe_collision_detectors)
+{
+    auto pexod = std::make_shared<Robot>(std::string(RESPATH) + "/models/pexod.urdf");
+    BOOST_REQUIRE(pexod);
+    pexod->skeleton()->setPosition(5, 0.2);
+
+    RobotDARTSimu simu(0.001);
+    simu.add_floor();
+    simu.add_robot(pexod);
+    // the robot is on the floor
+    simu.run(0.5);
+    Eigen::VectorXd q = pexod->positions();
+    double time = simu.world()->getTime();
+
+    auto probes = simu.probe_collision_detectors(0.05, 1e-2, false);
+    BOOST_REQUIRE(probes.size() >= 2);
+    BOOST_CHECK_EQUAL(probes[0].detector, "dart");
+    BOOST_CHECK(probes[0].consistent);
+    BOOST_CHECK_EQUAL(probes[0].position_error, 0.);
+    for (auto& probe : probes) {
+        BOOST_CHECK(probe.step_time > 0.);
+        BOOST_CHECK(probe.num_contacts > 0.);
+    }
+    // nothing changed
+    BOOST_CHECK_EQUAL(simu.collision_detector(), "dart");
+    BOOST_CHECK(pexod->positions() == q);
+    BOOST_CHECK_EQUAL(simu.world()->getTime(), time);
+
+    // the fastest consistent detector is kept
+    probes = simu.probe_collision_detectors(0.05);
+    bool found = false;
+    for (auto& probe : probes) {
+        if (probe.detector == simu.collision_detector()) {
+            BOOST_CHECK(probe.consistent);
+            found = true;
+        }
+    }
+    BOOST_CHECK(found);
+}
+
+BOOST_AUTO_TEST_CASE(test_sleeping)
+{
+    RobotDARTSimu simu(0.001);
+    simu.add_floor();
+    // a stack of two boxes, and a box alone
+    Eigen::Vector6d pose = Eigen::Vector6d::Zero();
+    for (size_t i = 0; i < 3; i++) {
+        pose.tail(3) << (i == 2 ? 1. : 0.), 0., (i == 1 ? 0.15 : 0.05);
+        simu.add_robot(Robot::create_box(Eigen::Vector3d(0.1, 0.1, 0.1), pose, "free", 1., dart::Color::Red(1.0), "box" + std::to_string(i)));
+    }
+
+    simu.enable_sleeping(true, 1e-2, 0.2);
+    BOOST_CHECK(simu.sleeping_enabled());
+    BOOST_CHECK_EQUAL(simu.num_sleeping(), 0);
+
+    simu.run(2.);
+    BOOST_CHECK_EQUAL(simu.num_sleeping(), 3);
+    // the sleeping boxes do not move and their contacts are skipped
+    Eigen::VectorXd q = simu.robot(1)->positions();
+    simu.run(0.5);
+    BOOST_CHECK(simu.robot(1)->positions() == q);
+    BOOST_CHECK_EQUAL(simu.world()->getLastCollisionResult().getNumContacts(), 0);
+
+    // an external force wakes up the stack, not the box alone
+    Eigen::VectorXd q0 = simu.robot(0)->positions();
+    simu.robot(0)->set_external_force(0, Eigen::Vector3d(30., 0., 0.));
+    simu.step_world();
+    BOOST_CHECK(!simu.sleeping(0));
+    BOOST_CHECK(!simu.sleeping(1));
+    BOOST_CHECK(simu.sleeping(2));
+    simu.run(0.1);
+    simu.robot(0)->clear_external_forces();
+    BOOST_CHECK(simu.robot(0)->positions()[3] > q0[3]);
+
+    // and everything falls asleep again
+    simu.run(2.);
+    BOOST_CHECK_EQUAL(simu.num_sleeping(), 3);
+
+    // so does a new velocity
+    simu.robot(2)->set_velocities(Eigen::VectorXd::Constant(6, 0.1));
+    simu.step_world();
+    BOOST_CHECK(!simu.sleeping(2));
+
+    simu.enable_sleeping(false);
+    BOOST_CHECK_EQUAL(simu.num_sleeping(), 0);
+    simu.step_world();
+    BOOST_CHECK(simu.world()->getLastCollisionResult().getNumContacts() > 0);
+}